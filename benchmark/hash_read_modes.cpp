@@ -0,0 +1,168 @@
+//
+// hash_read_modes.cpp - file hashing read mode benchmark
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+// Times hash_file in each read mode on files of the given sizes, to decide where automatic mode
+// should switch from mapped to direct reads. This program is not part of the library; build it as
+// a console application against the installed library, e.g.
+//
+//   cl /std:c++17 /EHsc /O2 /I \liblec\include hash_read_modes.cpp /link /LIBPATH:\liblec\lib
+//
+// and run it with leccore64.dll next to it:
+//
+//   hash_read_modes <directory> [size in MB]...
+//
+// The test files are written to the directory once, and kept for later runs. The default sizes
+// are 1 MB, 1 GB and 50 GB. Each mode hashes each file several times. The first run of a file
+// that fits in memory is usually served from the file cache, because the file was just written
+// or another mode just read it. To time cold reads of such files, empty the standby list
+// between runs, e.g. with RAMMap's "Empty Standby List". Files larger than memory are always
+// read cold.
+
+#include <liblec/leccore/hash.h>
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <vector>
+#include <string>
+
+using namespace liblec::leccore;
+
+namespace {
+	const int _runs = 3;
+
+	// write size_mb megabytes of pseudo-random data to fullpath, unless it is already there
+	bool make_file(const std::string& fullpath, unsigned long long size_mb) {
+		const unsigned long long size = size_mb * 1024 * 1024;
+
+		std::error_code code;
+		if (std::filesystem::file_size(fullpath, code) == size && !code)
+			return true;
+
+		std::ofstream file(fullpath, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		// data that does not compress, in case the volume compresses files
+		std::vector<unsigned long long> block(512 * 1024);
+		unsigned long long state = 0x9e3779b97f4a7c15ULL;
+
+		for (unsigned long long written = 0; written < size; written += 4 * 1024 * 1024) {
+			for (auto& word : block) {
+				state ^= state << 13;
+				state ^= state >> 7;
+				state ^= state << 17;
+				word = state;
+			}
+
+			file.write(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(block[0]));
+
+			if (!file)
+				return false;
+		}
+
+		return true;
+	}
+
+	// hash the file once and return the time taken, in seconds, or a negative number on error
+	double time_hash(const std::string& fullpath,
+		hash_file::read_mode mode,
+		const std::vector<hash_file::algorithm>& algorithms) {
+		hash_file hasher;
+		hasher.set_read_mode(mode);
+
+		const auto start = std::chrono::steady_clock::now();
+		hasher.start(fullpath, algorithms);
+
+		while (!hasher.wait(1000))
+			;
+
+		const auto end = std::chrono::steady_clock::now();
+
+		hash_file::hash_results results;
+		std::string error;
+		if (!hasher.result(results, error)) {
+			std::cerr << "Hashing " << fullpath << " failed: " << error << std::endl;
+			return -1.0;
+		}
+
+		return std::chrono::duration<double>(end - start).count();
+	}
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cerr << "Usage: hash_read_modes <directory> [size in MB]..." << std::endl;
+		return 1;
+	}
+
+	const std::string directory = argv[1];
+
+	std::vector<unsigned long long> sizes_mb;
+	for (int i = 2; i < argc; i++)
+		sizes_mb.push_back(std::stoull(argv[i]));
+
+	if (sizes_mb.empty())
+		sizes_mb = { 1, 1024, 50 * 1024 };
+
+	const std::vector<std::pair<std::string, hash_file::read_mode>> modes = {
+		{ "buffered", hash_file::read_mode::buffered },
+		{ "mapped", hash_file::read_mode::mapped },
+		{ "direct", hash_file::read_mode::direct },
+		{ "automatic", hash_file::read_mode::automatic },
+	};
+
+	// a slow hash and a fast one; the fast one shows the cost of the reads themselves
+	const std::vector<std::pair<std::string, std::vector<hash_file::algorithm>>> algorithm_sets = {
+		{ "sha256", { hash_file::algorithm::sha256 } },
+		{ "xxh3_64", { hash_file::algorithm::xxh3_64 } },
+	};
+
+	std::cout << std::left << std::setw(10) << "size (MB)" << std::setw(10) << "hash"
+		<< std::setw(11) << "mode" << std::setw(14) << "first (MB/s)" << "best (MB/s)" << std::endl;
+
+	for (const auto& size_mb : sizes_mb) {
+		const std::string fullpath =
+			(std::filesystem::path(directory) / ("hash_read_modes_" + std::to_string(size_mb) + ".bin")).string();
+
+		if (!make_file(fullpath, size_mb)) {
+			std::cerr << "Writing " << fullpath << " failed" << std::endl;
+			return 1;
+		}
+
+		for (const auto& algorithms : algorithm_sets) {
+			for (const auto& mode : modes) {
+				double first = 0.0, best = 0.0;
+
+				for (int run = 0; run < _runs; run++) {
+					const double seconds = time_hash(fullpath, mode.second, algorithms.second);
+					if (seconds < 0.0)
+						return 1;
+
+					const double rate = seconds > 0.0 ? size_mb / seconds : 0.0;
+
+					if (run == 0)
+						first = rate;
+
+					if (rate > best)
+						best = rate;
+				}
+
+				std::cout << std::left << std::setw(10) << size_mb << std::setw(10) << algorithms.first
+					<< std::setw(11) << mode.first << std::setw(14) << std::fixed << std::setprecision(0)
+					<< first << best << std::endl;
+			}
+		}
+	}
+
+	return 0;
+}
@@ -17,9 +17,67 @@
 #endif
 
 #include <string>
+#include <string_view>
+#include <functional>
 
 namespace liblec {
 	namespace leccore {
+		/// <summary>Base16 (hex) encoding/decoding class.</summary>
+		/// <remarks>Processors with AVX2 or SSSE3 encode and decode 16 to 32 bytes at a time.</remarks>
+		class leccore_api base16 {
+		public:
+			/// <summary>The case of the letters in the encoding.</summary>
+			enum class letter_case {
+				/// <summary>Lowercase letters, e.g. "3fa9".</summary>
+				lower,
+
+				/// <summary>Uppercase letters, e.g. "3FA9".</summary>
+				upper,
+			};
+
+			/// <summary>Encode to base16.</summary>
+			/// <param name="input">The data to be encoded.</param>
+			/// <param name="letters">The case of the letters, as defined in
+			/// <see cref="letter_case"></see>.</param>
+			/// <returns>The encoded result, two characters per byte.</returns>
+			[[nodiscard]]
+			static std::string encode(std::string_view input,
+				letter_case letters = letter_case::lower);
+
+			/// <summary>Decode from base16.</summary>
+			/// <param name="input">The data to be decoded.</param>
+			/// <returns>The decoded result.</returns>
+			/// <remarks>Both cases are accepted. Characters that are not hex digits, e.g. spaces
+			/// or line breaks, are skipped, and a digit left over at the end is dropped.</remarks>
+			[[nodiscard]]
+			static std::string decode(std::string_view input);
+
+			/// <summary>Encode to base16 into a caller-provided buffer.</summary>
+			/// <param name="data">A pointer to the data to be encoded.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			/// <param name="output">A buffer of at least 2 * <see cref="length"></see> characters
+			/// that receives the encoding. No terminating null is written.</param>
+			/// <param name="letters">The case of the letters, as defined in
+			/// <see cref="letter_case"></see>.</param>
+			/// <returns>The number of characters written.</returns>
+			/// <remarks>Nothing is allocated.</remarks>
+			static size_t encode(const void* data,
+				size_t length,
+				char* output,
+				letter_case letters = letter_case::lower);
+
+			/// <summary>Decode from base16 into a caller-provided buffer.</summary>
+			/// <param name="data">A pointer to the characters to be decoded.</param>
+			/// <param name="length">The number of characters.</param>
+			/// <param name="output">A buffer of at least <see cref="length"></see> / 2 bytes that
+			/// receives the decoded data.</param>
+			/// <returns>The number of bytes decoded.</returns>
+			/// <remarks>Nothing is allocated.</remarks>
+			static size_t decode(const char* data,
+				size_t length,
+				void* output);
+		};
+
 		/// <summary>Base32 encoding/decoding class.</summary>
 		class leccore_api base32 {
 		public:
@@ -29,21 +87,284 @@ namespace liblec {
 			[[nodiscard]]
 			static const std::string default_alphabet();
 			
+			/// <summary>Encode to base32 using the default alphabet.</summary>
+			/// <param name="input">The data to be encoded.</param>
+			/// <returns>The encoded result.</returns>
+			[[nodiscard]]
+			static std::string encode(std::string_view input);
+
 			/// <summary>Encode to base32.</summary>
 			/// <param name="input">The data to be encoded.</param>
 			/// <param name="alphabet">The alphabet to use for the encoding.</param>
 			/// <returns>The encoded result.</returns>
+			/// <remarks>The lookup tables of the alphabet are built on every call. Use a
+			/// <see cref="codec"></see> object to encode more than once with a custom alphabet.</remarks>
+			[[nodiscard]]
+			static std::string encode(std::string_view input,
+				const std::string& alphabet);
+
+			/// <summary>Encode to base32.</summary>
+			/// <param name="input">The data to be encoded.</param>
+			/// <param name="alphabet">The alphabet to use for the encoding.</param>
+			/// <returns>The encoded result.</returns>
+			/// <remarks>Forwards to the string_view overload. Programs built against earlier
+			/// versions of the library import this one.</remarks>
 			[[nodiscard]]
 			static std::string encode(const std::string& input,
-				std::string alphabet = default_alphabet());
+				std::string alphabet);
+
+			/// <summary>Encode to base32, from a null-terminated string.</summary>
+			/// <param name="input">The data to be encoded.</param>
+			/// <param name="alphabet">The alphabet to use for the encoding.</param>
+			/// <returns>The encoded result.</returns>
+			/// <remarks>A string literal would otherwise match both of the overloads above.</remarks>
+			[[nodiscard]]
+			static std::string encode(const char* input,
+				const std::string& alphabet) {
+				return encode(std::string_view(input), alphabet);
+			}
+
+			/// <summary>Decode from base32 using the default alphabet.</summary>
+			/// <param name="input">The data to be decoded.</param>
+			/// <returns>The decoded result.</returns>
+			[[nodiscard]]
+			static std::string decode(std::string_view input);
 
 			/// <summary>Decode from base32.</summary>
 			/// <param name="input">The data to be decoded.</param>
 			/// <param name="alphabet">The alphabet to use for the decoding.</param>
 			/// <returns>The decoded result.</returns>
+			/// <remarks>The lookup tables of the alphabet are built on every call. Use a
+			/// <see cref="codec"></see> object to decode more than once with a custom alphabet.</remarks>
+			[[nodiscard]]
+			static std::string decode(std::string_view input,
+				const std::string& alphabet);
+
+			/// <summary>Decode from base32.</summary>
+			/// <param name="input">The data to be decoded.</param>
+			/// <param name="alphabet">The alphabet to use for the decoding.</param>
+			/// <returns>The decoded result.</returns>
+			/// <remarks>Forwards to the string_view overload. Programs built against earlier
+			/// versions of the library import this one.</remarks>
 			[[nodiscard]]
 			static std::string decode(const std::string& input,
-				std::string alphabet = default_alphabet());
+				std::string alphabet);
+
+			/// <summary>Decode from base32, from a null-terminated string.</summary>
+			/// <param name="input">The data to be decoded.</param>
+			/// <param name="alphabet">The alphabet to use for the decoding.</param>
+			/// <returns>The decoded result.</returns>
+			/// <remarks>A string literal would otherwise match both of the overloads above.</remarks>
+			[[nodiscard]]
+			static std::string decode(const char* input,
+				const std::string& alphabet) {
+				return decode(std::string_view(input), alphabet);
+			}
+
+			/// <summary>Get the size of the buffer that encoding needs.</summary>
+			/// <param name="length">The length of the data to be encoded, in bytes.</param>
+			/// <returns>The number of characters the encoding of <see cref="length"></see> bytes
+			/// has.</returns>
+			[[nodiscard]]
+			static size_t encode_buffer_size(size_t length);
+
+			/// <summary>Get the size of the buffer that decoding needs.</summary>
+			/// <param name="length">The number of characters to be decoded.</param>
+			/// <returns>The minimum size of the output buffer, in bytes. It can be slightly
+			/// larger than the decoded data turns out to be.</returns>
+			[[nodiscard]]
+			static size_t decode_buffer_size(size_t length);
+
+			/// <summary>Encode to base32 into a caller-provided buffer, using the default
+			/// alphabet.</summary>
+			/// <param name="data">A pointer to the data to be encoded.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			/// <param name="output">A buffer of at least <see cref="encode_buffer_size"></see>
+			/// characters that receives the encoding. No terminating null is written.</param>
+			/// <returns>The number of characters written.</returns>
+			/// <remarks>Nothing is allocated.</remarks>
+			static size_t encode(const void* data,
+				size_t length,
+				char* output);
+
+			/// <summary>Decode from base32 into a caller-provided buffer, using the default
+			/// alphabet.</summary>
+			/// <param name="data">A pointer to the characters to be decoded.</param>
+			/// <param name="length">The number of characters.</param>
+			/// <param name="output">A buffer of at least <see cref="decode_buffer_size"></see>
+			/// bytes that receives the decoded data.</param>
+			/// <returns>The number of bytes decoded.</returns>
+			/// <remarks>Nothing is allocated.</remarks>
+			static size_t decode(const char* data,
+				size_t length,
+				void* output);
+
+			class encoder;
+			class decoder;
+
+			/// <summary>A base32 encoder/decoder for one alphabet.</summary>
+			/// <remarks>The lookup tables of the alphabet are built once, in the constructor.
+			/// The object is not modified after that, so one object can be shared by any
+			/// number of threads.</remarks>
+			class leccore_api codec {
+			public:
+				/// <summary>Constructor.</summary>
+				/// <param name="alphabet">The alphabet to use. If it is not 32 characters long
+				/// the default alphabet is used instead.</param>
+				codec(const std::string& alphabet = default_alphabet());
+				~codec();
+
+				/// <summary>Encode to base32.</summary>
+				/// <param name="input">The data to be encoded.</param>
+				/// <returns>The encoded result.</returns>
+				[[nodiscard]]
+				std::string encode(std::string_view input) const;
+
+				/// <summary>Decode from base32.</summary>
+				/// <param name="input">The data to be decoded.</param>
+				/// <returns>The decoded result.</returns>
+				[[nodiscard]]
+				std::string decode(std::string_view input) const;
+
+				/// <summary>Encode to base32 into a caller-provided buffer.</summary>
+				/// <param name="data">A pointer to the data to be encoded.</param>
+				/// <param name="length">The length of the data, in bytes.</param>
+				/// <param name="output">A buffer of at least
+				/// <see cref="base32::encode_buffer_size"></see> characters that receives the
+				/// encoding. No terminating null is written.</param>
+				/// <returns>The number of characters written.</returns>
+				/// <remarks>Nothing is allocated.</remarks>
+				size_t encode(const void* data,
+					size_t length,
+					char* output) const;
+
+				/// <summary>Decode from base32 into a caller-provided buffer.</summary>
+				/// <param name="data">A pointer to the characters to be decoded.</param>
+				/// <param name="length">The number of characters.</param>
+				/// <param name="output">A buffer of at least
+				/// <see cref="base32::decode_buffer_size"></see> bytes that receives the decoded
+				/// data.</param>
+				/// <returns>The number of bytes decoded.</returns>
+				/// <remarks>Nothing is allocated.</remarks>
+				size_t decode(const char* data,
+					size_t length,
+					void* output) const;
+
+			private:
+				class impl;
+				impl& _d;
+
+				friend class encoder;
+				friend class decoder;
+
+				// Copying an object of this class is not allowed
+				codec(const codec&) = delete;
+				codec& operator=(const codec&) = delete;
+			};
+
+			/// <summary>Receives the output of an <see cref="encoder"></see> or
+			/// <see cref="decoder"></see>, a piece at a time.</summary>
+			using sink = std::function<void(const char* data, size_t length)>;
+
+			/// <summary>Streaming base32 encoder. Use this to encode data that arrives in chunks,
+			/// e.g. a large file, without holding all of it, or all of the result, in memory.</summary>
+			/// <remarks>Input that does not make up a whole group yet is carried over to the next
+			/// call to <see cref="update"></see>. The memory used does not depend on the size of
+			/// the input. The output is the same as that of <see cref="base32::encode"></see>.</remarks>
+			class leccore_api encoder {
+			public:
+				/// <summary>Constructor, for the default alphabet.</summary>
+				/// <param name="output">The sink that receives the encoded data.</param>
+				encoder(sink output);
+
+				/// <summary>Constructor.</summary>
+				/// <param name="output">The sink that receives the encoded data.</param>
+				/// <param name="alphabet">The codec of the alphabet to use. It has to outlive
+				/// this object.</param>
+				encoder(sink output, const codec& alphabet);
+				~encoder();
+
+				/// <summary>Add data to encode.</summary>
+				/// <param name="data">A pointer to the data.</param>
+				/// <param name="length">The length of the data, in bytes.</param>
+				void update(const void* data, size_t length);
+
+				/// <summary>Encode what is left over and pass it to the sink.</summary>
+				/// <remarks>The object is reset, ready for the next input.</remarks>
+				void finalize();
+
+			private:
+				class impl;
+				impl& _d;
+
+				// Default constructor and copying an object of this class are not allowed
+				encoder() = delete;
+				encoder(const encoder&) = delete;
+				encoder& operator=(const encoder&) = delete;
+			};
+
+			/// <summary>Streaming base32 decoder. Use this to decode data that arrives in chunks,
+			/// e.g. a large file, without holding all of it, or all of the result, in memory.</summary>
+			/// <remarks>Characters of a group that is not complete yet are carried over to the
+			/// next call to <see cref="update"></see>. The memory used does not depend on the size
+			/// of the input. The output is the same as that of <see cref="base32::decode"></see>.</remarks>
+			class leccore_api decoder {
+			public:
+				/// <summary>Constructor, for the default alphabet.</summary>
+				/// <param name="output">The sink that receives the decoded data.</param>
+				decoder(sink output);
+
+				/// <summary>Constructor.</summary>
+				/// <param name="output">The sink that receives the decoded data.</param>
+				/// <param name="alphabet">The codec of the alphabet to use. It has to outlive
+				/// this object.</param>
+				decoder(sink output, const codec& alphabet);
+				~decoder();
+
+				/// <summary>Add encoded characters to decode.</summary>
+				/// <param name="data">A pointer to the characters.</param>
+				/// <param name="length">The number of characters.</param>
+				void update(const char* data, size_t length);
+
+				/// <summary>Decode what is left over and pass it to the sink.</summary>
+				/// <remarks>The object is reset, ready for the next input.</remarks>
+				void finalize();
+
+			private:
+				class impl;
+				impl& _d;
+
+				// Default constructor and copying an object of this class are not allowed
+				decoder() = delete;
+				decoder(const decoder&) = delete;
+				decoder& operator=(const decoder&) = delete;
+			};
+
+			/// <summary>Encode a file to base32, using the default alphabet.</summary>
+			/// <param name="source">The full path to the file to encode.</param>
+			/// <param name="destination">The full path to the file to write the encoded data to.
+			/// It is overwritten if it exists.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>The file is streamed through an <see cref="encoder"></see>, so files of
+			/// any size can be encoded.</remarks>
+			[[nodiscard]]
+			static bool encode_file(const std::string& source,
+				const std::string& destination,
+				std::string& error);
+
+			/// <summary>Decode a base32 encoded file, using the default alphabet.</summary>
+			/// <param name="source">The full path to the file to decode.</param>
+			/// <param name="destination">The full path to the file to write the decoded data to.
+			/// It is overwritten if it exists.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>The file is streamed through a <see cref="decoder"></see>, so files of
+			/// any size can be decoded.</remarks>
+			[[nodiscard]]
+			static bool decode_file(const std::string& source,
+				const std::string& destination,
+				std::string& error);
 		};
 
 		/// <summary>Base64 encoding/decoding class.</summary>
@@ -55,21 +376,284 @@ namespace liblec {
 			[[nodiscard]]
 			static const std::string default_alphabet();
 
+			/// <summary>Encode to base64 using the default alphabet.</summary>
+			/// <param name="input">The data to be encoded.</param>
+			/// <returns>The encoded result.</returns>
+			[[nodiscard]]
+			static std::string encode(std::string_view input);
+
+			/// <summary>Encode to base64.</summary>
+			/// <param name="input">The data to be encoded.</param>
+			/// <param name="alphabet">The alphabet to use for the encoding.</param>
+			/// <returns>The encoded result.</returns>
+			/// <remarks>The lookup tables of the alphabet are built on every call. Use a
+			/// <see cref="codec"></see> object to encode more than once with a custom alphabet.</remarks>
+			[[nodiscard]]
+			static std::string encode(std::string_view input,
+				const std::string& alphabet);
+
 			/// <summary>Encode to base64.</summary>
 			/// <param name="input">The data to be encoded.</param>
 			/// <param name="alphabet">The alphabet to use for the encoding.</param>
 			/// <returns>The encoded result.</returns>
+			/// <remarks>Forwards to the string_view overload. Programs built against earlier
+			/// versions of the library import this one.</remarks>
 			[[nodiscard]]
 			static std::string encode(const std::string& input,
-				std::string alphabet = default_alphabet());
+				std::string alphabet);
+
+			/// <summary>Encode to base64, from a null-terminated string.</summary>
+			/// <param name="input">The data to be encoded.</param>
+			/// <param name="alphabet">The alphabet to use for the encoding.</param>
+			/// <returns>The encoded result.</returns>
+			/// <remarks>A string literal would otherwise match both of the overloads above.</remarks>
+			[[nodiscard]]
+			static std::string encode(const char* input,
+				const std::string& alphabet) {
+				return encode(std::string_view(input), alphabet);
+			}
+
+			/// <summary>Decode from base64 using the default alphabet.</summary>
+			/// <param name="input">The data to be decoded.</param>
+			/// <returns>The decoded result.</returns>
+			[[nodiscard]]
+			static std::string decode(std::string_view input);
 
 			/// <summary>Decode from base64.</summary>
 			/// <param name="input">The data to be decoded.</param>
 			/// <param name="alphabet">The alphabet to use for the decoding.</param>
 			/// <returns>The decoded result.</returns>
+			/// <remarks>The lookup tables of the alphabet are built on every call. Use a
+			/// <see cref="codec"></see> object to decode more than once with a custom alphabet.</remarks>
+			[[nodiscard]]
+			static std::string decode(std::string_view input,
+				const std::string& alphabet);
+
+			/// <summary>Decode from base64.</summary>
+			/// <param name="input">The data to be decoded.</param>
+			/// <param name="alphabet">The alphabet to use for the decoding.</param>
+			/// <returns>The decoded result.</returns>
+			/// <remarks>Forwards to the string_view overload. Programs built against earlier
+			/// versions of the library import this one.</remarks>
 			[[nodiscard]]
 			static std::string decode(const std::string& input,
-				std::string alphabet = default_alphabet());
+				std::string alphabet);
+
+			/// <summary>Decode from base64, from a null-terminated string.</summary>
+			/// <param name="input">The data to be decoded.</param>
+			/// <param name="alphabet">The alphabet to use for the decoding.</param>
+			/// <returns>The decoded result.</returns>
+			/// <remarks>A string literal would otherwise match both of the overloads above.</remarks>
+			[[nodiscard]]
+			static std::string decode(const char* input,
+				const std::string& alphabet) {
+				return decode(std::string_view(input), alphabet);
+			}
+
+			/// <summary>Get the size of the buffer that encoding needs.</summary>
+			/// <param name="length">The length of the data to be encoded, in bytes.</param>
+			/// <returns>The number of characters the encoding of <see cref="length"></see> bytes
+			/// has.</returns>
+			[[nodiscard]]
+			static size_t encode_buffer_size(size_t length);
+
+			/// <summary>Get the size of the buffer that decoding needs.</summary>
+			/// <param name="length">The number of characters to be decoded.</param>
+			/// <returns>The minimum size of the output buffer, in bytes. It can be slightly
+			/// larger than the decoded data turns out to be.</returns>
+			[[nodiscard]]
+			static size_t decode_buffer_size(size_t length);
+
+			/// <summary>Encode to base64 into a caller-provided buffer, using the default
+			/// alphabet.</summary>
+			/// <param name="data">A pointer to the data to be encoded.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			/// <param name="output">A buffer of at least <see cref="encode_buffer_size"></see>
+			/// characters that receives the encoding. No terminating null is written.</param>
+			/// <returns>The number of characters written.</returns>
+			/// <remarks>Nothing is allocated.</remarks>
+			static size_t encode(const void* data,
+				size_t length,
+				char* output);
+
+			/// <summary>Decode from base64 into a caller-provided buffer, using the default
+			/// alphabet.</summary>
+			/// <param name="data">A pointer to the characters to be decoded.</param>
+			/// <param name="length">The number of characters.</param>
+			/// <param name="output">A buffer of at least <see cref="decode_buffer_size"></see>
+			/// bytes that receives the decoded data.</param>
+			/// <returns>The number of bytes decoded.</returns>
+			/// <remarks>Nothing is allocated.</remarks>
+			static size_t decode(const char* data,
+				size_t length,
+				void* output);
+
+			class encoder;
+			class decoder;
+
+			/// <summary>A base64 encoder/decoder for one alphabet.</summary>
+			/// <remarks>The lookup tables of the alphabet are built once, in the constructor.
+			/// The object is not modified after that, so one object can be shared by any
+			/// number of threads.</remarks>
+			class leccore_api codec {
+			public:
+				/// <summary>Constructor.</summary>
+				/// <param name="alphabet">The alphabet to use. If it is not 64 characters long
+				/// the default alphabet is used instead.</param>
+				codec(const std::string& alphabet = default_alphabet());
+				~codec();
+
+				/// <summary>Encode to base64.</summary>
+				/// <param name="input">The data to be encoded.</param>
+				/// <returns>The encoded result.</returns>
+				[[nodiscard]]
+				std::string encode(std::string_view input) const;
+
+				/// <summary>Decode from base64.</summary>
+				/// <param name="input">The data to be decoded.</param>
+				/// <returns>The decoded result.</returns>
+				[[nodiscard]]
+				std::string decode(std::string_view input) const;
+
+				/// <summary>Encode to base64 into a caller-provided buffer.</summary>
+				/// <param name="data">A pointer to the data to be encoded.</param>
+				/// <param name="length">The length of the data, in bytes.</param>
+				/// <param name="output">A buffer of at least
+				/// <see cref="base64::encode_buffer_size"></see> characters that receives the
+				/// encoding. No terminating null is written.</param>
+				/// <returns>The number of characters written.</returns>
+				/// <remarks>Nothing is allocated.</remarks>
+				size_t encode(const void* data,
+					size_t length,
+					char* output) const;
+
+				/// <summary>Decode from base64 into a caller-provided buffer.</summary>
+				/// <param name="data">A pointer to the characters to be decoded.</param>
+				/// <param name="length">The number of characters.</param>
+				/// <param name="output">A buffer of at least
+				/// <see cref="base64::decode_buffer_size"></see> bytes that receives the decoded
+				/// data.</param>
+				/// <returns>The number of bytes decoded.</returns>
+				/// <remarks>Nothing is allocated.</remarks>
+				size_t decode(const char* data,
+					size_t length,
+					void* output) const;
+
+			private:
+				class impl;
+				impl& _d;
+
+				friend class encoder;
+				friend class decoder;
+
+				// Copying an object of this class is not allowed
+				codec(const codec&) = delete;
+				codec& operator=(const codec&) = delete;
+			};
+
+			/// <summary>Receives the output of an <see cref="encoder"></see> or
+			/// <see cref="decoder"></see>, a piece at a time.</summary>
+			using sink = std::function<void(const char* data, size_t length)>;
+
+			/// <summary>Streaming base64 encoder. Use this to encode data that arrives in chunks,
+			/// e.g. a large file, without holding all of it, or all of the result, in memory.</summary>
+			/// <remarks>Input that does not make up a whole group yet is carried over to the next
+			/// call to <see cref="update"></see>. The memory used does not depend on the size of
+			/// the input. The output is the same as that of <see cref="base64::encode"></see>.</remarks>
+			class leccore_api encoder {
+			public:
+				/// <summary>Constructor, for the default alphabet.</summary>
+				/// <param name="output">The sink that receives the encoded data.</param>
+				encoder(sink output);
+
+				/// <summary>Constructor.</summary>
+				/// <param name="output">The sink that receives the encoded data.</param>
+				/// <param name="alphabet">The codec of the alphabet to use. It has to outlive
+				/// this object.</param>
+				encoder(sink output, const codec& alphabet);
+				~encoder();
+
+				/// <summary>Add data to encode.</summary>
+				/// <param name="data">A pointer to the data.</param>
+				/// <param name="length">The length of the data, in bytes.</param>
+				void update(const void* data, size_t length);
+
+				/// <summary>Encode what is left over and pass it to the sink.</summary>
+				/// <remarks>The object is reset, ready for the next input.</remarks>
+				void finalize();
+
+			private:
+				class impl;
+				impl& _d;
+
+				// Default constructor and copying an object of this class are not allowed
+				encoder() = delete;
+				encoder(const encoder&) = delete;
+				encoder& operator=(const encoder&) = delete;
+			};
+
+			/// <summary>Streaming base64 decoder. Use this to decode data that arrives in chunks,
+			/// e.g. a large file, without holding all of it, or all of the result, in memory.</summary>
+			/// <remarks>Characters of a group that is not complete yet are carried over to the
+			/// next call to <see cref="update"></see>. The memory used does not depend on the size
+			/// of the input. The output is the same as that of <see cref="base64::decode"></see>.</remarks>
+			class leccore_api decoder {
+			public:
+				/// <summary>Constructor, for the default alphabet.</summary>
+				/// <param name="output">The sink that receives the decoded data.</param>
+				decoder(sink output);
+
+				/// <summary>Constructor.</summary>
+				/// <param name="output">The sink that receives the decoded data.</param>
+				/// <param name="alphabet">The codec of the alphabet to use. It has to outlive
+				/// this object.</param>
+				decoder(sink output, const codec& alphabet);
+				~decoder();
+
+				/// <summary>Add encoded characters to decode.</summary>
+				/// <param name="data">A pointer to the characters.</param>
+				/// <param name="length">The number of characters.</param>
+				void update(const char* data, size_t length);
+
+				/// <summary>Decode what is left over and pass it to the sink.</summary>
+				/// <remarks>The object is reset, ready for the next input.</remarks>
+				void finalize();
+
+			private:
+				class impl;
+				impl& _d;
+
+				// Default constructor and copying an object of this class are not allowed
+				decoder() = delete;
+				decoder(const decoder&) = delete;
+				decoder& operator=(const decoder&) = delete;
+			};
+
+			/// <summary>Encode a file to base64, using the default alphabet.</summary>
+			/// <param name="source">The full path to the file to encode.</param>
+			/// <param name="destination">The full path to the file to write the encoded data to.
+			/// It is overwritten if it exists.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>The file is streamed through an <see cref="encoder"></see>, so files of
+			/// any size can be encoded.</remarks>
+			[[nodiscard]]
+			static bool encode_file(const std::string& source,
+				const std::string& destination,
+				std::string& error);
+
+			/// <summary>Decode a base64 encoded file, using the default alphabet.</summary>
+			/// <param name="source">The full path to the file to decode.</param>
+			/// <param name="destination">The full path to the file to write the decoded data to.
+			/// It is overwritten if it exists.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>The file is streamed through a <see cref="decoder"></see>, so files of
+			/// any size can be decoded.</remarks>
+			[[nodiscard]]
+			static bool decode_file(const std::string& source,
+				const std::string& destination,
+				std::string& error);
 		};
 	}
 }
@@ -0,0 +1,280 @@
+//
+// base16.cpp - base16 encoding/decoding implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../encode.h"
+#include <cryptlib.h>
+#include <cpu.h>
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define LECCORE_BASE16_SIMD
+#endif
+
+using namespace liblec::leccore;
+
+namespace {
+	const char _lower_digits[] = "0123456789abcdef";
+	const char _upper_digits[] = "0123456789ABCDEF";
+
+	enum class simd_level { none, ssse3, avx2 };
+
+	simd_level simd() {
+		static const simd_level level = []() {
+#if defined(LECCORE_BASE16_SIMD)
+			if (CryptoPP::HasAVX2())
+				return simd_level::avx2;
+
+			if (CryptoPP::HasSSSE3())
+				return simd_level::ssse3;
+#endif
+			return simd_level::none;
+		}();
+
+		return level;
+	}
+
+	// hex digit to value, or -1 for characters that are not hex digits
+	struct decode_table {
+		int8_t values[256];
+
+		decode_table() {
+			for (int c = 0; c < 256; c++)
+				values[c] = -1;
+
+			for (int i = 0; i < 10; i++)
+				values['0' + i] = static_cast<int8_t>(i);
+
+			for (int i = 0; i < 6; i++) {
+				values['a' + i] = static_cast<int8_t>(10 + i);
+				values['A' + i] = static_cast<int8_t>(10 + i);
+			}
+		}
+	};
+
+	const decode_table _decode;
+
+#if defined(LECCORE_BASE16_SIMD)
+	// encode 16 bytes into 32 characters at a time; returns the number of bytes encoded
+	size_t encode_ssse3(const uint8_t* input, size_t length, char* output, const char* digits) {
+		const __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits));
+		const __m128i mask = _mm_set1_epi8(0x0f);
+
+		size_t done = 0;
+		for (; length - done >= 16; done += 16) {
+			const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + done));
+			const __m128i high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+			const __m128i low = _mm_shuffle_epi8(table, _mm_and_si128(in, mask));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2 * done), _mm_unpacklo_epi8(high, low));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2 * done + 16), _mm_unpackhi_epi8(high, low));
+		}
+
+		return done;
+	}
+
+	// encode 32 bytes into 64 characters at a time; returns the number of bytes encoded
+	size_t encode_avx2(const uint8_t* input, size_t length, char* output, const char* digits) {
+		const __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(digits)));
+		const __m256i mask = _mm256_set1_epi8(0x0f);
+
+		size_t done = 0;
+		for (; length - done >= 32; done += 32) {
+			const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + done));
+			const __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+			const __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(in, mask));
+
+			// the unpacks work within each 128 bit lane, so put the lanes back in order
+			const __m256i first = _mm256_unpacklo_epi8(high, low);
+			const __m256i second = _mm256_unpackhi_epi8(high, low);
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 2 * done),
+				_mm256_permute2x128_si256(first, second, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + 2 * done + 32),
+				_mm256_permute2x128_si256(first, second, 0x31));
+		}
+
+		return done;
+	}
+
+	// The values of 16 hex digits, in either case. Returns false if any character is not a hex
+	// digit.
+	inline bool digit_values(__m128i characters, __m128i& values) {
+		const __m128i digit = _mm_sub_epi8(characters, _mm_set1_epi8('0'));
+		const __m128i letter = _mm_sub_epi8(_mm_or_si128(characters, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+
+		// unsigned range checks: x <= limit exactly when min(x, limit) == x
+		const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+		const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+		if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xffff)
+			return false;
+
+		values = _mm_or_si128(_mm_and_si128(is_digit, digit),
+			_mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+		return true;
+	}
+
+	inline bool digit_values(__m256i characters, __m256i& values) {
+		const __m256i digit = _mm256_sub_epi8(characters, _mm256_set1_epi8('0'));
+		const __m256i letter = _mm256_sub_epi8(_mm256_or_si256(characters, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+
+		const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+		const __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+
+		if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)) != -1)
+			return false;
+
+		values = _mm256_or_si256(_mm256_and_si256(is_digit, digit),
+			_mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+		return true;
+	}
+
+	// decode 32 characters into 16 bytes, if they are all hex digits
+	inline bool decode_ssse3(const char* input, uint8_t* output) {
+		__m128i first, second;
+
+		if (!digit_values(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input)), first) ||
+			!digit_values(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 16)), second))
+			return false;
+
+		// 16 * high + low for each pair of digits
+		const __m128i weights = _mm_set1_epi16(0x0110);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+			_mm_packus_epi16(_mm_maddubs_epi16(first, weights), _mm_maddubs_epi16(second, weights)));
+		return true;
+	}
+
+	// decode 64 characters into 32 bytes, if they are all hex digits
+	inline bool decode_avx2(const char* input, uint8_t* output) {
+		__m256i first, second;
+
+		if (!digit_values(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input)), first) ||
+			!digit_values(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + 32)), second))
+			return false;
+
+		const __m256i weights = _mm256_set1_epi16(0x0110);
+		const __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(first, weights),
+			_mm256_maddubs_epi16(second, weights));
+
+		// the pack works within each 128 bit lane
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(output), _mm256_permute4x64_epi64(packed, 0xd8));
+		return true;
+	}
+#endif
+}
+
+std::string liblec::leccore::base16::encode(std::string_view input, letter_case letters) {
+	std::string encoded;
+	try {
+		encoded.resize(2 * input.size());
+		encode(input.data(), input.size(), &encoded[0], letters);
+	}
+	catch (const std::exception&) {
+		// to-do: log
+	}
+
+	return encoded;
+}
+
+std::string liblec::leccore::base16::decode(std::string_view input) {
+	std::string decoded;
+	try {
+		decoded.resize(input.size() / 2);
+		decoded.resize(decode(input.data(), input.size(), &decoded[0]));
+	}
+	catch (const std::exception&) {
+		// to-do: log
+	}
+
+	return decoded;
+}
+
+size_t liblec::leccore::base16::encode(const void* data, size_t length,
+	char* output, letter_case letters) {
+	const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+	const char* digits = letters == letter_case::upper ? _upper_digits : _lower_digits;
+	size_t done = 0;
+
+#if defined(LECCORE_BASE16_SIMD)
+	const simd_level level = simd();
+
+	if (level == simd_level::avx2)
+		done = encode_avx2(input, length, output, digits);
+
+	if (level != simd_level::none)
+		done += encode_ssse3(input + done, length - done, output + 2 * done, digits);
+#endif
+
+	for (; done < length; done++) {
+		output[2 * done] = digits[input[done] >> 4];
+		output[2 * done + 1] = digits[input[done] & 0x0f];
+	}
+
+	return 2 * length;
+}
+
+size_t liblec::leccore::base16::decode(const char* data, size_t length, void* output) {
+	uint8_t* out = reinterpret_cast<uint8_t*>(output);
+	size_t written = 0;
+	size_t i = 0;
+
+	// a digit that does not have its pair yet, or -1
+	int pending = -1;
+
+#if defined(LECCORE_BASE16_SIMD)
+	const simd_level level = simd();
+	const size_t block = level == simd_level::avx2 ? 64 : 32;
+
+	while (level != simd_level::none && length - i >= block) {
+		// whole blocks of hex digits are decoded with SIMD, anything else, e.g. a block with a
+		// line break in it, one character at a time
+		if (pending < 0) {
+			const bool decoded = level == simd_level::avx2 ?
+				decode_avx2(data + i, out + written) : decode_ssse3(data + i, out + written);
+
+			if (decoded) {
+				i += block;
+				written += block / 2;
+				continue;
+			}
+		}
+
+		for (const size_t end = i + block; i < end; i++) {
+			const int value = _decode.values[static_cast<uint8_t>(data[i])];
+			if (value < 0)
+				continue;
+
+			if (pending < 0)
+				pending = value;
+			else {
+				out[written++] = static_cast<uint8_t>((pending << 4) | value);
+				pending = -1;
+			}
+		}
+	}
+#endif
+
+	for (; i < length; i++) {
+		const int value = _decode.values[static_cast<uint8_t>(data[i])];
+		if (value < 0)
+			continue;
+
+		if (pending < 0)
+			pending = value;
+		else {
+			out[written++] = static_cast<uint8_t>((pending << 4) | value);
+			pending = -1;
+		}
+	}
+
+	return written;
+}
@@ -9,31 +9,123 @@
 //
 
 #include "../encode.h"
-#include <cryptlib.h>
-#include <base32.h>
+#include "stream_file.h"
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include <vector>
+#include <algorithm>
 
-const std::string liblec::leccore::base32::default_alphabet() {
-    return std::string("ABCDEFGHIJKLMNOPQRSTUVWXYZ234567");
+using namespace liblec::leccore;
+
+namespace {
+    const char* _default_alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+    // built on first use and shared by all threads from then on
+    const base32::codec& default_codec() {
+        static const base32::codec codec;
+        return codec;
+    }
 }
 
-std::string liblec::leccore::base32::encode(const std::string& input,
-    std::string alphabet) {
+class base32::codec::impl {
+public:
+    // index to character
+    char _encode[32];
+
+    // character to index, or -1 for characters that are not in the alphabet
+    int8_t _decode[256];
+
+    // bits that do not make up a whole byte yet
+    struct decode_state {
+        unsigned int bits = 0;
+        unsigned int bit_count = 0;
+    };
+
+    impl(const std::string& alphabet) {
+        const std::string& chars = alphabet.length() == 32 ? alphabet : std::string(_default_alphabet);
+        memcpy(_encode, chars.data(), sizeof(_encode));
+        memset(_decode, -1, sizeof(_decode));
+
+        // decoding is case insensitive, as it was with Crypto++'s Base32Decoder
+        for (int i = 0; i < 32; i++) {
+            const unsigned char c = static_cast<unsigned char>(chars[i]);
+
+            if (isalpha(c)) {
+                _decode[toupper(c)] = static_cast<int8_t>(i);
+                _decode[tolower(c)] = static_cast<int8_t>(i);
+            }
+            else
+                _decode[c] = static_cast<int8_t>(i);
+        }
+    }
+    ~impl() {}
+
+    // encode whole 5 byte groups, 8 characters each; returns the end of the output
+    char* encode_groups(const uint8_t* in, size_t groups, char* out) const {
+        for (; groups > 0; groups--, in += 5) {
+            const uint64_t group = (static_cast<uint64_t>(in[0]) << 32) |
+                (static_cast<uint64_t>(in[1]) << 24) | (static_cast<uint64_t>(in[2]) << 16) |
+                (static_cast<uint64_t>(in[3]) << 8) | static_cast<uint64_t>(in[4]);
+
+            for (int c = 0; c < 8; c++)
+                *out++ = _encode[(group >> (35 - 5 * c)) & 0x1f];
+        }
+
+        return out;
+    }
+
+    // encode the last 0 to 4 bytes, with the last bits padded with zeros to a whole character,
+    // and no padding characters; returns the end of the output
+    char* encode_tail(const uint8_t* in, size_t length, char* out) const {
+        unsigned int bits = 0;
+        unsigned int bit_count = 0;
+
+        for (size_t i = 0; i < length; i++) {
+            bits = (bits << 8) | in[i];
+            bit_count += 8;
+
+            while (bit_count >= 5) {
+                bit_count -= 5;
+                *out++ = _encode[(bits >> bit_count) & 0x1f];
+            }
+        }
+
+        if (bit_count)
+            *out++ = _encode[(bits << (5 - bit_count)) & 0x1f];
+
+        return out;
+    }
+
+    // Characters that are not in the alphabet, e.g. padding, are skipped. Bits that do not
+    // make up a whole byte are kept in state, and dropped at the end. Returns the end of the output.
+    char* decode(const char* in, size_t length, decode_state& state, char* out) const {
+        for (size_t i = 0; i < length; i++) {
+            const int value = _decode[static_cast<unsigned char>(in[i])];
+            if (value < 0)
+                continue;
+
+            state.bits = ((state.bits << 5) | static_cast<unsigned int>(value)) & 0xfff;
+            state.bit_count += 5;
+
+            if (state.bit_count >= 8) {
+                state.bit_count -= 8;
+                *out++ = static_cast<char>(state.bits >> state.bit_count);
+            }
+        }
+
+        return out;
+    }
+};
+
+base32::codec::codec(const std::string& alphabet) : _d(*new impl(alphabet)) {}
+base32::codec::~codec() { delete& _d; }
+
+std::string base32::codec::encode(std::string_view input) const {
     std::string encoded;
     try {
-        if (alphabet.length() != 32)
-            alphabet = default_alphabet();
-        
-        const CryptoPP::AlgorithmParameters encoder_params =
-            CryptoPP::MakeParameters(CryptoPP::Name::EncodingLookupArray(),
-                (const CryptoPP::byte*)alphabet.c_str());
-
-        CryptoPP::Base32Encoder* p_encoder =
-            new CryptoPP::Base32Encoder(new CryptoPP::StringSink(encoded));
-        p_encoder->IsolatedInitialize(encoder_params);
-        CryptoPP::StringSource ss(input, true, p_encoder);
-    }
-    catch (CryptoPP::Exception&) {
-        // to-do: log
+        encoded.resize(encode_buffer_size(input.size()));
+        encode(input.data(), input.size(), &encoded[0]);
     }
     catch (const std::exception&) {
         // to-do: log
@@ -42,27 +134,11 @@ std::string liblec::leccore::base32::encode(const std::string& input,
     return encoded;
 }
 
-std::string liblec::leccore::base32::decode(const std::string& input,
-    std::string alphabet) {
+std::string base32::codec::decode(std::string_view input) const {
     std::string decoded;
     try {
-        if (alphabet.length() != 32)
-            alphabet = default_alphabet();
-
-        int decoder_lookup[256];
-        CryptoPP::Base32Decoder::InitializeDecodingLookupArray(decoder_lookup,
-            (const CryptoPP::byte*)alphabet.c_str(), 32, true);
-        const CryptoPP::AlgorithmParameters decoder_params =
-            CryptoPP::MakeParameters(CryptoPP::Name::DecodingLookupArray(),
-                (const int*)decoder_lookup);
-
-        CryptoPP::Base32Decoder* p_decoder =
-            new CryptoPP::Base32Decoder(new CryptoPP::StringSink(decoded));
-        p_decoder->IsolatedInitialize(decoder_params);
-        CryptoPP::StringSource ss(input, true, p_decoder);
-    }
-    catch (CryptoPP::Exception&) {
-        // to-do: log
+        decoded.resize(decode_buffer_size(input.size()));
+        decoded.resize(decode(input.data(), input.size(), &decoded[0]));
     }
     catch (const std::exception&) {
         // to-do: log
@@ -70,3 +146,191 @@ std::string liblec::leccore::base32::decode(const std::string& input,
 
     return decoded;
 }
+
+size_t base32::codec::encode(const void* data, size_t length, char* output) const {
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+    char* out = _d.encode_groups(in, length / 5, output);
+    out = _d.encode_tail(in + length / 5 * 5, length % 5, out);
+    return out - output;
+}
+
+size_t base32::codec::decode(const char* data, size_t length, void* output) const {
+    impl::decode_state state;
+    char* out = reinterpret_cast<char*>(output);
+    return _d.decode(data, length, state, out) - out;
+}
+
+class base32::encoder::impl {
+public:
+    // groups encoded per call to the sink
+    static constexpr size_t _block_groups = 8 * 1024;
+
+    const codec::impl& _codec;
+    sink _output;
+
+    // input that does not make up a whole group yet
+    uint8_t _pending[5];
+    size_t _pending_length = 0;
+
+    std::vector<char> _buffer;
+
+    impl(sink output, const codec::impl& codec) :
+        _codec(codec),
+        _output(output),
+        _buffer(8 * _block_groups) {}
+    ~impl() {}
+
+    void encode(const uint8_t* data, size_t groups) {
+        const char* end = _codec.encode_groups(data, groups, _buffer.data());
+        _output(_buffer.data(), end - _buffer.data());
+    }
+};
+
+base32::encoder::encoder(sink output) : encoder(output, default_codec()) {}
+base32::encoder::encoder(sink output, const codec& alphabet) :
+    _d(*new impl(output, alphabet._d)) {}
+base32::encoder::~encoder() { delete& _d; }
+
+void base32::encoder::update(const void* data, size_t length) {
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+
+    if (_d._pending_length) {
+        const size_t take = (std::min)(length, sizeof(_d._pending) - _d._pending_length);
+        memcpy(_d._pending + _d._pending_length, input, take);
+        _d._pending_length += take;
+        input += take;
+        length -= take;
+
+        if (_d._pending_length < sizeof(_d._pending))
+            return;
+
+        _d._pending_length = 0;
+        _d.encode(_d._pending, 1);
+    }
+
+    while (length >= 5) {
+        const size_t groups = (std::min)(length / 5, impl::_block_groups);
+        _d.encode(input, groups);
+        input += 5 * groups;
+        length -= 5 * groups;
+    }
+
+    memcpy(_d._pending, input, length);
+    _d._pending_length = length;
+}
+
+void base32::encoder::finalize() {
+    if (_d._pending_length) {
+        const char* end = _d._codec.encode_tail(_d._pending, _d._pending_length, _d._buffer.data());
+        _d._output(_d._buffer.data(), end - _d._buffer.data());
+    }
+
+    _d._pending_length = 0;
+}
+
+class base32::decoder::impl {
+public:
+    // characters decoded per call to the sink
+    static constexpr size_t _block_characters = 64 * 1024;
+
+    const codec::impl& _codec;
+    sink _output;
+    codec::impl::decode_state _state;
+    std::vector<char> _buffer;
+
+    impl(sink output, const codec::impl& codec) :
+        _codec(codec),
+        _output(output),
+        _buffer(_block_characters * 5 / 8 + 1) {}
+    ~impl() {}
+};
+
+base32::decoder::decoder(sink output) : decoder(output, default_codec()) {}
+base32::decoder::decoder(sink output, const codec& alphabet) :
+    _d(*new impl(output, alphabet._d)) {}
+base32::decoder::~decoder() { delete& _d; }
+
+void base32::decoder::update(const char* data, size_t length) {
+    while (length) {
+        const size_t take = (std::min)(length, impl::_block_characters);
+        const char* end = _d._codec.decode(data, take, _d._state, _d._buffer.data());
+
+        if (end != _d._buffer.data())
+            _d._output(_d._buffer.data(), end - _d._buffer.data());
+
+        data += take;
+        length -= take;
+    }
+}
+
+void base32::decoder::finalize() {
+    // the bits left over do not make up a whole byte
+    _d._state = codec::impl::decode_state();
+}
+
+const std::string liblec::leccore::base32::default_alphabet() {
+    return std::string(_default_alphabet);
+}
+
+std::string liblec::leccore::base32::encode(std::string_view input) {
+    return default_codec().encode(input);
+}
+
+std::string liblec::leccore::base32::encode(std::string_view input,
+    const std::string& alphabet) {
+    if (alphabet.length() != 32 || alphabet == _default_alphabet)
+        return default_codec().encode(input);
+
+    return codec(alphabet).encode(input);
+}
+
+std::string liblec::leccore::base32::encode(const std::string& input,
+    std::string alphabet) {
+    return encode(std::string_view(input), alphabet);
+}
+
+std::string liblec::leccore::base32::decode(std::string_view input) {
+    return default_codec().decode(input);
+}
+
+std::string liblec::leccore::base32::decode(std::string_view input,
+    const std::string& alphabet) {
+    if (alphabet.length() != 32 || alphabet == _default_alphabet)
+        return default_codec().decode(input);
+
+    return codec(alphabet).decode(input);
+}
+
+std::string liblec::leccore::base32::decode(const std::string& input,
+    std::string alphabet) {
+    return decode(std::string_view(input), alphabet);
+}
+
+size_t liblec::leccore::base32::encode_buffer_size(size_t length) {
+    // 8 characters for every 5 bytes, and no padding
+    return (length * 8 + 4) / 5;
+}
+
+size_t liblec::leccore::base32::decode_buffer_size(size_t length) {
+    return length * 5 / 8;
+}
+
+size_t liblec::leccore::base32::encode(const void* data, size_t length, char* output) {
+    return default_codec().encode(data, length, output);
+}
+
+size_t liblec::leccore::base32::decode(const char* data, size_t length, void* output) {
+    return default_codec().decode(data, length, output);
+}
+
+bool liblec::leccore::base32::encode_file(const std::string& source,
+    const std::string& destination,
+    std::string& error) {
+    return stream_file<encoder>(source, destination, error);
+}
+
+bool liblec::leccore::base32::decode_file(const std::string& source,
+    const std::string& destination,
+    std::string& error) {
+    return stream_file<decoder>(source, destination, error);
+}
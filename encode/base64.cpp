@@ -9,31 +9,42 @@
 //
 
 #include "../encode.h"
-#include <cryptlib.h>
-#include <base64.h>
+#include "base64_kernels.h"
+#include "stream_file.h"
+#include <vector>
+#include <cstring>
+#include <algorithm>
 
-const std::string liblec::leccore::base64::default_alphabet() {
-    return std::string("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/");
-}
+using namespace liblec::leccore;
 
-std::string liblec::leccore::base64::encode(const std::string& input,
-    std::string alphabet) {
-    std::string encoded;
-    try {
-        if (alphabet.length() != 64)
-            alphabet = default_alphabet();
+namespace {
+    const char* _default_alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-        const CryptoPP::AlgorithmParameters encoder_params =
-            CryptoPP::MakeParameters(CryptoPP::Name::EncodingLookupArray(),
-                (const CryptoPP::byte*)alphabet.c_str());
+    // built on first use and shared by all threads from then on
+    const base64::codec& default_codec() {
+        static const base64::codec codec;
+        return codec;
+    }
+}
+
+class base64::codec::impl {
+public:
+    base64_tables _tables;
 
-        CryptoPP::Base64Encoder* p_encoder =
-            new CryptoPP::Base64Encoder(new CryptoPP::StringSink(encoded));
-        p_encoder->IsolatedInitialize(encoder_params);
-        CryptoPP::StringSource ss(input, true, p_encoder);
+    impl(const std::string& alphabet) {
+        make_base64_tables(alphabet.length() == 64 ? alphabet : _default_alphabet, _tables);
     }
-    catch (CryptoPP::Exception&) {
-        // to-do: log
+    ~impl() {}
+};
+
+base64::codec::codec(const std::string& alphabet) : _d(*new impl(alphabet)) {}
+base64::codec::~codec() { delete& _d; }
+
+std::string base64::codec::encode(std::string_view input) const {
+    std::string encoded;
+    try {
+        encoded.resize(encode_buffer_size(input.size()));
+        encode(input.data(), input.size(), &encoded[0]);
     }
     catch (const std::exception&) {
         // to-do: log
@@ -42,27 +53,11 @@ std::string liblec::leccore::base64::encode(const std::string& input,
     return encoded;
 }
 
-std::string liblec::leccore::base64::decode(const std::string& input,
-    std::string alphabet) {
+std::string base64::codec::decode(std::string_view input) const {
     std::string decoded;
     try {
-        if (alphabet.length() != 64)
-            alphabet = default_alphabet();
-
-        int decoder_lookup[256];
-        CryptoPP::Base64Decoder::InitializeDecodingLookupArray(decoder_lookup,
-            (const CryptoPP::byte*)alphabet.c_str(), 64, false);
-        const CryptoPP::AlgorithmParameters decoder_params =
-            CryptoPP::MakeParameters(CryptoPP::Name::DecodingLookupArray(),
-                (const int*)decoder_lookup);
-
-        CryptoPP::Base64Decoder* p_decoder =
-            new CryptoPP::Base64Decoder(new CryptoPP::StringSink(decoded));
-        p_decoder->IsolatedInitialize(decoder_params);
-        CryptoPP::StringSource ss(input, true, p_decoder);
-    }
-    catch (CryptoPP::Exception&) {
-        // to-do: log
+        decoded.resize(decode_buffer_size(input.size()));
+        decoded.resize(decode(input.data(), input.size(), &decoded[0]));
     }
     catch (const std::exception&) {
         // to-do: log
@@ -70,3 +65,193 @@ std::string liblec::leccore::base64::decode(const std::string& input,
 
     return decoded;
 }
+
+size_t base64::codec::encode(const void* data, size_t length, char* output) const {
+    base64_encode(_d._tables, reinterpret_cast<const uint8_t*>(data), length, output, true);
+    return base64_encoded_length(length, true);
+}
+
+size_t base64::codec::decode(const char* data, size_t length, void* output) const {
+    return base64_decode(_d._tables, data, length, reinterpret_cast<uint8_t*>(output));
+}
+
+class base64::encoder::impl {
+public:
+    // lines encoded per call to the sink
+    static constexpr size_t _block_bytes = 1024 * base64_line_bytes;
+
+    const base64_tables& _tables;
+    sink _output;
+
+    // input that does not make up a whole line yet
+    uint8_t _pending[base64_line_bytes];
+    size_t _pending_length = 0;
+
+    bool _started = false;
+    std::vector<char> _buffer;
+
+    impl(sink output, const base64_tables& tables) :
+        _tables(tables),
+        _output(output),
+        _buffer(base64_encoded_length(_block_bytes, true)) {}
+    ~impl() {}
+
+    // whole lines encode to the same characters on their own as they do as part of a longer input
+    void encode(const uint8_t* data, size_t length) {
+        const size_t encoded = base64_encoded_length(length, true);
+        base64_encode(_tables, data, length, _buffer.data(), true);
+
+        _started = true;
+        _output(_buffer.data(), encoded);
+    }
+};
+
+base64::encoder::encoder(sink output) : encoder(output, default_codec()) {}
+base64::encoder::encoder(sink output, const codec& alphabet) :
+    _d(*new impl(output, alphabet._d._tables)) {}
+base64::encoder::~encoder() { delete& _d; }
+
+void base64::encoder::update(const void* data, size_t length) {
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(data);
+
+    if (_d._pending_length) {
+        const size_t take = (std::min)(length, base64_line_bytes - _d._pending_length);
+        memcpy(_d._pending + _d._pending_length, input, take);
+        _d._pending_length += take;
+        input += take;
+        length -= take;
+
+        if (_d._pending_length < base64_line_bytes)
+            return;
+
+        _d._pending_length = 0;
+        _d.encode(_d._pending, base64_line_bytes);
+    }
+
+    while (length >= base64_line_bytes) {
+        const size_t take = (std::min)(length / base64_line_bytes * base64_line_bytes, impl::_block_bytes);
+        _d.encode(input, take);
+        input += take;
+        length -= take;
+    }
+
+    memcpy(_d._pending, input, length);
+    _d._pending_length = length;
+}
+
+void base64::encoder::finalize() {
+    // empty input still encodes to a line break, as it does with base64::encode
+    if (_d._pending_length || !_d._started)
+        _d.encode(_d._pending, _d._pending_length);
+
+    _d._pending_length = 0;
+    _d._started = false;
+}
+
+class base64::decoder::impl {
+public:
+    // characters decoded per call to the sink
+    static constexpr size_t _block_characters = 64 * 1024;
+
+    const base64_tables& _tables;
+    sink _output;
+    base64_decode_state _state;
+    std::vector<uint8_t> _buffer;
+
+    impl(sink output, const base64_tables& tables) :
+        _tables(tables),
+        _output(output),
+        _buffer(base64_decode_buffer_size(_block_characters)) {}
+    ~impl() {}
+
+    void decode(const char* data, size_t length, bool last) {
+        const size_t decoded = base64_decode(_tables, data, length, _buffer.data(), _state, last);
+
+        if (decoded)
+            _output(reinterpret_cast<const char*>(_buffer.data()), decoded);
+    }
+};
+
+base64::decoder::decoder(sink output) : decoder(output, default_codec()) {}
+base64::decoder::decoder(sink output, const codec& alphabet) :
+    _d(*new impl(output, alphabet._d._tables)) {}
+base64::decoder::~decoder() { delete& _d; }
+
+void base64::decoder::update(const char* data, size_t length) {
+    while (length) {
+        const size_t take = (std::min)(length, impl::_block_characters);
+        _d.decode(data, take, false);
+        data += take;
+        length -= take;
+    }
+}
+
+void base64::decoder::finalize() {
+    _d.decode(nullptr, 0, true);
+}
+
+const std::string liblec::leccore::base64::default_alphabet() {
+    return std::string(_default_alphabet);
+}
+
+std::string liblec::leccore::base64::encode(std::string_view input) {
+    return default_codec().encode(input);
+}
+
+std::string liblec::leccore::base64::encode(std::string_view input,
+    const std::string& alphabet) {
+    if (alphabet.length() != 64 || alphabet == _default_alphabet)
+        return default_codec().encode(input);
+
+    return codec(alphabet).encode(input);
+}
+
+std::string liblec::leccore::base64::encode(const std::string& input,
+    std::string alphabet) {
+    return encode(std::string_view(input), alphabet);
+}
+
+std::string liblec::leccore::base64::decode(std::string_view input) {
+    return default_codec().decode(input);
+}
+
+std::string liblec::leccore::base64::decode(std::string_view input,
+    const std::string& alphabet) {
+    if (alphabet.length() != 64 || alphabet == _default_alphabet)
+        return default_codec().decode(input);
+
+    return codec(alphabet).decode(input);
+}
+
+std::string liblec::leccore::base64::decode(const std::string& input,
+    std::string alphabet) {
+    return decode(std::string_view(input), alphabet);
+}
+
+size_t liblec::leccore::base64::encode_buffer_size(size_t length) {
+    return base64_encoded_length(length, true);
+}
+
+size_t liblec::leccore::base64::decode_buffer_size(size_t length) {
+    return base64_decode_buffer_size(length);
+}
+
+size_t liblec::leccore::base64::encode(const void* data, size_t length, char* output) {
+    return default_codec().encode(data, length, output);
+}
+
+size_t liblec::leccore::base64::decode(const char* data, size_t length, void* output) {
+    return default_codec().decode(data, length, output);
+}
+
+bool liblec::leccore::base64::encode_file(const std::string& source,
+    const std::string& destination,
+    std::string& error) {
+    return stream_file<encoder>(source, destination, error);
+}
+
+bool liblec::leccore::base64::decode_file(const std::string& source,
+    const std::string& destination,
+    std::string& error) {
+    return stream_file<decoder>(source, destination, error);
+}
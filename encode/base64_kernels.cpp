@@ -0,0 +1,439 @@
+//
+// base64_kernels.cpp - base64 encoding/decoding kernels implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "base64_kernels.h"
+#include <cryptlib.h>
+#include <cpu.h>
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define LECCORE_BASE64_SIMD
+#endif
+
+using namespace liblec::leccore;
+
+// the length of a line of the encoding, without the line break
+static const size_t _line_length = base64_line_bytes / 3 * 4;
+
+namespace {
+	enum class simd_level { none, ssse3, avx2 };
+
+	simd_level simd() {
+		static const simd_level level = []() {
+#if defined(LECCORE_BASE64_SIMD)
+			if (CryptoPP::HasAVX2())
+				return simd_level::avx2;
+
+			if (CryptoPP::HasSSSE3())
+				return simd_level::ssse3;
+#endif
+			return simd_level::none;
+		}();
+
+		return level;
+	}
+
+	// encode whole 3 byte groups, then the padded remainder
+	void encode_scalar(const base64_tables& tables, const uint8_t* input, size_t length, char* output) {
+		const uint8_t* alphabet = tables.encode;
+
+		for (; length >= 3; length -= 3) {
+			const uint32_t group = (static_cast<uint32_t>(input[0]) << 16) |
+				(static_cast<uint32_t>(input[1]) << 8) | input[2];
+
+			output[0] = static_cast<char>(alphabet[group >> 18]);
+			output[1] = static_cast<char>(alphabet[(group >> 12) & 0x3f]);
+			output[2] = static_cast<char>(alphabet[(group >> 6) & 0x3f]);
+			output[3] = static_cast<char>(alphabet[group & 0x3f]);
+
+			input += 3;
+			output += 4;
+		}
+
+		if (length > 0) {
+			const uint32_t group = (static_cast<uint32_t>(input[0]) << 16) |
+				(length > 1 ? static_cast<uint32_t>(input[1]) << 8 : 0);
+
+			output[0] = static_cast<char>(alphabet[group >> 18]);
+			output[1] = static_cast<char>(alphabet[(group >> 12) & 0x3f]);
+			output[2] = length > 1 ? static_cast<char>(alphabet[(group >> 6) & 0x3f]) : '=';
+			output[3] = '=';
+		}
+	}
+
+#if defined(LECCORE_BASE64_SIMD)
+	// Split each 3 byte group of the first 12 bytes of every 128 bit lane into four 6 bit indices,
+	// one per byte; see W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding using AVX2
+	// Instructions".
+	template <typename vec, typename ops>
+	inline vec split_indices(vec in) {
+		in = ops::shuffle(in, ops::setr_bytes(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+		const vec t0 = ops::and_(in, ops::set32(0x0fc0fc00));
+		const vec t1 = ops::mulhi_epu16(t0, ops::set32(0x04000040));
+		const vec t2 = ops::and_(in, ops::set32(0x003f03f0));
+		const vec t3 = ops::mullo_epi16(t2, ops::set32(0x01000010));
+		return ops::or_(t1, t3);
+	}
+
+	// Map 6 bit indices to the characters of any alphabet: look the low four bits up in each of the
+	// four rows of 16 characters, then pick the row with bits 4 and 5.
+	template <typename vec, typename ops>
+	inline vec lookup_characters(vec indices, const vec rows[4]) {
+		const vec r0 = ops::shuffle(rows[0], indices);
+		const vec r1 = ops::shuffle(rows[1], indices);
+		const vec r2 = ops::shuffle(rows[2], indices);
+		const vec r3 = ops::shuffle(rows[3], indices);
+
+		const vec bit4 = ops::cmpeq(ops::and_(indices, ops::set8(0x10)), ops::set8(0x10));
+		const vec bit5 = ops::cmpeq(ops::and_(indices, ops::set8(0x20)), ops::set8(0x20));
+
+		return ops::select(bit5, ops::select(bit4, r3, r2), ops::select(bit4, r1, r0));
+	}
+
+	// Map characters to their 6 bit values through the rows of the decode table; characters that
+	// are not in the alphabet come out as 0xff, so their top bit is set.
+	template <typename vec, typename ops>
+	inline vec lookup_values(vec characters, const vec* rows, const vec* nibbles, unsigned int row_count) {
+		const vec high = ops::and_(ops::srli16(characters, 4), ops::set8(0x0f));
+		const vec low = ops::and_(characters, ops::set8(0x0f));
+
+		vec values = ops::set8(0xff);
+		for (unsigned int r = 0; r < row_count; r++)
+			values = ops::select(ops::cmpeq(high, nibbles[r]), ops::shuffle(rows[r], low), values);
+
+		return values;
+	}
+
+	// Pack the four 6 bit values in each 32 bit element into 3 bytes, at the front of every 128 bit
+	// lane.
+	template <typename vec, typename ops>
+	inline vec pack_values(vec values) {
+		const vec merged = ops::maddubs(values, ops::set32(0x01400140));
+		const vec packed = ops::madd(merged, ops::set32(0x00011000));
+		return ops::shuffle(packed, ops::setr_bytes(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+	}
+
+	struct sse {
+		using vec = __m128i;
+
+		static vec shuffle(vec a, vec b) { return _mm_shuffle_epi8(a, b); }
+		static vec and_(vec a, vec b) { return _mm_and_si128(a, b); }
+		static vec or_(vec a, vec b) { return _mm_or_si128(a, b); }
+		static vec cmpeq(vec a, vec b) { return _mm_cmpeq_epi8(a, b); }
+		static vec mulhi_epu16(vec a, vec b) { return _mm_mulhi_epu16(a, b); }
+		static vec mullo_epi16(vec a, vec b) { return _mm_mullo_epi16(a, b); }
+		static vec maddubs(vec a, vec b) { return _mm_maddubs_epi16(a, b); }
+		static vec madd(vec a, vec b) { return _mm_madd_epi16(a, b); }
+		static vec srli16(vec a, int n) { return _mm_srli_epi16(a, n); }
+		static vec set8(int x) { return _mm_set1_epi8(static_cast<char>(x)); }
+		static vec set32(int x) { return _mm_set1_epi32(x); }
+		static vec setr_bytes(char b0, char b1, char b2, char b3, char b4, char b5, char b6, char b7,
+			char b8, char b9, char b10, char b11, char b12, char b13, char b14, char b15) {
+			return _mm_setr_epi8(b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14, b15);
+		}
+
+		// blendv is SSE4.1, so pick with masks instead
+		static vec select(vec mask, vec a, vec b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+
+		static vec broadcast(const uint8_t* p) { return _mm_load_si128(reinterpret_cast<const vec*>(p)); }
+	};
+
+	struct avx {
+		using vec = __m256i;
+
+		static vec shuffle(vec a, vec b) { return _mm256_shuffle_epi8(a, b); }
+		static vec and_(vec a, vec b) { return _mm256_and_si256(a, b); }
+		static vec or_(vec a, vec b) { return _mm256_or_si256(a, b); }
+		static vec cmpeq(vec a, vec b) { return _mm256_cmpeq_epi8(a, b); }
+		static vec mulhi_epu16(vec a, vec b) { return _mm256_mulhi_epu16(a, b); }
+		static vec mullo_epi16(vec a, vec b) { return _mm256_mullo_epi16(a, b); }
+		static vec maddubs(vec a, vec b) { return _mm256_maddubs_epi16(a, b); }
+		static vec madd(vec a, vec b) { return _mm256_madd_epi16(a, b); }
+		static vec srli16(vec a, int n) { return _mm256_srli_epi16(a, n); }
+		static vec set8(int x) { return _mm256_set1_epi8(static_cast<char>(x)); }
+		static vec set32(int x) { return _mm256_set1_epi32(x); }
+		static vec setr_bytes(char b0, char b1, char b2, char b3, char b4, char b5, char b6, char b7,
+			char b8, char b9, char b10, char b11, char b12, char b13, char b14, char b15) {
+			return _mm256_setr_epi8(b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14, b15,
+				b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14, b15);
+		}
+		static vec select(vec mask, vec a, vec b) { return _mm256_blendv_epi8(b, a, mask); }
+
+		static vec broadcast(const uint8_t* p) {
+			return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(p)));
+		}
+	};
+
+	// encode 12 bytes at a time while 16 can be read; returns the number of bytes encoded
+	size_t encode_ssse3(const base64_tables& tables, const uint8_t* input, size_t length, char* output) {
+		__m128i rows[4];
+		for (int r = 0; r < 4; r++)
+			rows[r] = sse::broadcast(tables.encode + 16 * r);
+
+		size_t done = 0;
+		for (; length - done >= 16; done += 12) {
+			const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + done));
+			const __m128i indices = split_indices<__m128i, sse>(in);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + done / 3 * 4),
+				lookup_characters<__m128i, sse>(indices, rows));
+		}
+
+		return done;
+	}
+
+	// encode 24 bytes at a time while 28 can be read; returns the number of bytes encoded
+	size_t encode_avx2(const base64_tables& tables, const uint8_t* input, size_t length, char* output) {
+		__m256i rows[4];
+		for (int r = 0; r < 4; r++)
+			rows[r] = avx::broadcast(tables.encode + 16 * r);
+
+		size_t done = 0;
+		for (; length - done >= 28; done += 24) {
+			// 12 bytes for each lane
+			const __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + done))),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + done + 12)), 1);
+
+			const __m256i indices = split_indices<__m256i, avx>(in);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + done / 3 * 4),
+				lookup_characters<__m256i, avx>(indices, rows));
+		}
+
+		return done;
+	}
+
+	// Decode 16 characters into 12 bytes, writing 16. Returns false, with the position of the first
+	// character that is not in the alphabet, if there is one.
+	inline bool decode_ssse3(const __m128i* rows, const __m128i* nibbles, unsigned int row_count,
+		const char* input, uint8_t* output, unsigned int& invalid_at) {
+		const __m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+		const __m128i values = lookup_values<__m128i, sse>(characters, rows, nibbles, row_count);
+
+		unsigned int invalid = static_cast<unsigned int>(_mm_movemask_epi8(values));
+		if (invalid) {
+			for (invalid_at = 0; !(invalid & 1); invalid >>= 1)
+				invalid_at++;
+
+			return false;
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output), pack_values<__m128i, sse>(values));
+		return true;
+	}
+
+	// decode 32 characters into 24 bytes, writing 32; see decode_ssse3
+	inline bool decode_avx2(const __m256i* rows, const __m256i* nibbles, unsigned int row_count,
+		const char* input, uint8_t* output, unsigned int& invalid_at) {
+		const __m256i characters = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input));
+		const __m256i values = lookup_values<__m256i, avx>(characters, rows, nibbles, row_count);
+
+		unsigned int invalid = static_cast<unsigned int>(_mm256_movemask_epi8(values));
+		if (invalid) {
+			for (invalid_at = 0; !(invalid & 1); invalid >>= 1)
+				invalid_at++;
+
+			return false;
+		}
+
+		// bring the 12 bytes at the front of each lane together
+		const __m256i packed = _mm256_permutevar8x32_epi32(pack_values<__m256i, avx>(values),
+			_mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(output), packed);
+		return true;
+	}
+#endif
+
+	void encode_run(const base64_tables& tables, const uint8_t* input, size_t length, char* output) {
+		size_t done = 0;
+
+#if defined(LECCORE_BASE64_SIMD)
+		const simd_level level = simd();
+
+		if (level == simd_level::avx2)
+			done = encode_avx2(tables, input, length, output);
+		else if (level == simd_level::ssse3)
+			done = encode_ssse3(tables, input, length, output);
+#endif
+
+		encode_scalar(tables, input + done, length - done, output + done / 3 * 4);
+	}
+
+	// returns the number of bytes written
+	inline size_t decode_character(const base64_tables& tables, char c, base64_decode_state& state, uint8_t* output) {
+		const int value = tables.decode[static_cast<uint8_t>(c)];
+		if (value < 0)
+			return 0;
+
+		state.bits = (state.bits << 6) | static_cast<uint32_t>(value);
+
+		if (++state.count < 4)
+			return 0;
+
+		output[0] = static_cast<uint8_t>(state.bits >> 16);
+		output[1] = static_cast<uint8_t>(state.bits >> 8);
+		output[2] = static_cast<uint8_t>(state.bits);
+
+		state.bits = 0;
+		state.count = 0;
+		return 3;
+	}
+}
+
+void liblec::leccore::make_base64_tables(const std::string& alphabet, base64_tables& tables) {
+	memset(tables.encode, 0, sizeof(tables.encode));
+	memcpy(tables.encode, alphabet.data(), (std::min)(alphabet.size(), sizeof(tables.encode)));
+
+	// later characters win, as they do in Crypto++
+	memset(tables.decode, -1, sizeof(tables.decode));
+	for (size_t i = 0; i < alphabet.size() && i < 64; i++)
+		tables.decode[static_cast<uint8_t>(alphabet[i])] = static_cast<int8_t>(i);
+
+	tables.rows = 0;
+	for (unsigned int high = 0; high < 16; high++) {
+		bool used = false;
+		for (unsigned int low = 0; low < 16; low++)
+			if (tables.decode[16 * high + low] >= 0)
+				used = true;
+
+		if (!used)
+			continue;
+
+		for (unsigned int low = 0; low < 16; low++) {
+			const int8_t value = tables.decode[16 * high + low];
+			tables.decode_rows[tables.rows][low] = value < 0 ? 0xff : static_cast<uint8_t>(value);
+		}
+
+		tables.row_nibbles[tables.rows] = static_cast<uint8_t>(high);
+		tables.rows++;
+	}
+}
+
+size_t liblec::leccore::base64_encoded_length(size_t length, bool line_breaks) {
+	const size_t characters = (length + 2) / 3 * 4;
+
+	if (!line_breaks)
+		return characters;
+
+	// one line break per line, including the last, and a lone one for empty input
+	const size_t lines = (std::max)(static_cast<size_t>(1), (characters + _line_length - 1) / _line_length);
+	return characters + lines;
+}
+
+void liblec::leccore::base64_encode(const base64_tables& tables,
+	const uint8_t* input, size_t length,
+	char* output, bool line_breaks) {
+	if (!line_breaks) {
+		encode_run(tables, input, length, output);
+		return;
+	}
+
+	do {
+		const size_t take = (std::min)(length, base64_line_bytes);
+		encode_run(tables, input, take, output);
+
+		output += (take + 2) / 3 * 4;
+		*output++ = '\n';
+
+		input += take;
+		length -= take;
+	} while (length > 0);
+}
+
+size_t liblec::leccore::base64_decode_buffer_size(size_t length) {
+	return length / 4 * 3 + 3 + 32;
+}
+
+size_t liblec::leccore::base64_decode(const base64_tables& tables,
+	const char* input, size_t length,
+	uint8_t* output) {
+	base64_decode_state state;
+	return base64_decode(tables, input, length, output, state, true);
+}
+
+size_t liblec::leccore::base64_decode(const base64_tables& tables,
+	const char* input, size_t length,
+	uint8_t* output,
+	base64_decode_state& state, bool last) {
+	size_t written = 0;
+	size_t i = 0;
+
+	// finish the group the previous chunk ended in, so that the SIMD code starts on a group
+	for (; i < length && state.count != 0; i++)
+		written += decode_character(tables, input[i], state, output + written);
+
+#if defined(LECCORE_BASE64_SIMD)
+	const simd_level level = simd();
+
+	if (level != simd_level::none) {
+		__m256i rows_avx[16], nibbles_avx[16];
+		__m128i rows_sse[16], nibbles_sse[16];
+
+		for (unsigned int r = 0; r < tables.rows; r++) {
+			if (level == simd_level::avx2) {
+				rows_avx[r] = avx::broadcast(tables.decode_rows[r]);
+				nibbles_avx[r] = avx::set8(tables.row_nibbles[r]);
+			}
+			else {
+				rows_sse[r] = sse::broadcast(tables.decode_rows[r]);
+				nibbles_sse[r] = sse::set8(tables.row_nibbles[r]);
+			}
+		}
+
+		const size_t block = level == simd_level::avx2 ? 32 : 16;
+
+		while (length - i >= block) {
+			// whole blocks of characters of the alphabet, e.g. a line, are decoded with SIMD
+			unsigned int invalid_at = 0;
+			bool decoded = false;
+
+			if (level == simd_level::avx2)
+				decoded = decode_avx2(rows_avx, nibbles_avx, tables.rows, input + i, output + written, invalid_at);
+			else
+				decoded = decode_ssse3(rows_sse, nibbles_sse, tables.rows, input + i, output + written, invalid_at);
+
+			if (decoded) {
+				i += block;
+				written += block / 4 * 3;
+				continue;
+			}
+
+			// decode up to and including the first character that is not in the alphabet, then up to
+			// the end of the group the scalar decoder is in, so that the SIMD code starts on a group
+			const size_t end = i + invalid_at + 1;
+			for (; i < end; i++)
+				written += decode_character(tables, input[i], state, output + written);
+
+			for (; i < length && state.count != 0; i++)
+				written += decode_character(tables, input[i], state, output + written);
+		}
+	}
+#endif
+
+	for (; i < length; i++)
+		written += decode_character(tables, input[i], state, output + written);
+
+	if (!last)
+		return written;
+
+	// the whole bytes in what is left
+	if (state.count > 1) {
+		const uint32_t bits = state.bits << (6 * (4 - state.count));
+		output[written++] = static_cast<uint8_t>(bits >> 16);
+
+		if (state.count == 3)
+			output[written++] = static_cast<uint8_t>(bits >> 8);
+	}
+
+	state = base64_decode_state();
+	return written;
+}
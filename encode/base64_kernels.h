@@ -0,0 +1,74 @@
+//
+// base64_kernels.h - base64 encoding/decoding kernels interface
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+namespace liblec {
+	namespace leccore {
+		// The lookup tables of one base64 alphabet, for both the scalar and the SIMD code. Any
+		// alphabet of 64 characters is supported, including ones that do not follow the layout of the
+		// standard alphabet.
+		struct base64_tables {
+			// index to character, in four rows of 16 for the SIMD lookups
+			alignas(16) uint8_t encode[64];
+
+			// character to index, or -1 for characters that are not in the alphabet
+			int8_t decode[256];
+
+			// The decode table again, in rows of 16 characters that share their high nibble; only the
+			// rows with at least one character of the alphabet are kept. Missing characters are 0xff.
+			alignas(16) uint8_t decode_rows[16][16];
+			uint8_t row_nibbles[16];
+			unsigned int rows;
+		};
+
+		// Crypto++'s Base64Encoder breaks lines after 72 characters, i.e. this many input bytes
+		const size_t base64_line_bytes = 54;
+
+		// build the tables of a 64 character alphabet
+		void make_base64_tables(const std::string& alphabet, base64_tables& tables);
+
+		// The length of the encoding of length bytes. With line breaks the output matches the one of
+		// Crypto++'s Base64Encoder: a new line after every 72 characters and one at the end.
+		size_t base64_encoded_length(size_t length, bool line_breaks);
+
+		// encode length bytes into exactly base64_encoded_length(length, line_breaks) characters
+		void base64_encode(const base64_tables& tables,
+			const uint8_t* input, size_t length,
+			char* output, bool line_breaks);
+
+		// The size of the buffer that decoding length characters needs. It is slightly larger than the
+		// decoded data can be, because the SIMD code writes whole vectors.
+		size_t base64_decode_buffer_size(size_t length);
+
+		// Decode length characters and return the number of bytes written. Like Crypto++'s
+		// Base64Decoder, characters that are not in the alphabet, e.g. line breaks and padding, are
+		// skipped, and bits left over at the end that do not make up a whole byte are dropped.
+		size_t base64_decode(const base64_tables& tables,
+			const char* input, size_t length,
+			uint8_t* output);
+
+		// up to three characters of a group that has not been completed yet
+		struct base64_decode_state {
+			uint32_t bits = 0;
+			unsigned int count = 0;
+		};
+
+		// Decode one chunk of a longer input, carrying an incomplete group over to the next chunk in
+		// state. The leftover bits are only written, and state reset, when last is true.
+		size_t base64_decode(const base64_tables& tables,
+			const char* input, size_t length,
+			uint8_t* output,
+			base64_decode_state& state, bool last);
+	}
+}
@@ -0,0 +1,81 @@
+//
+// stream_file.h - streaming a file through an encoder or decoder
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+namespace liblec {
+	namespace leccore {
+		// Pass the source file through a stream of stream_type, e.g. base64::encoder, a chunk at a
+		// time, and write its output to the destination file.
+		template <typename stream_type>
+		bool stream_file(const std::string& source,
+			const std::string& destination,
+			std::string& error) {
+			error.clear();
+			try {
+				std::ifstream file_in(source, std::ios::binary);
+
+				if (!file_in.is_open()) {
+					error = "Opening source file failed";
+					return false;
+				}
+
+				std::ofstream file_out(destination, std::ios::out | std::ios::trunc | std::ios::binary);
+
+				if (!file_out.is_open()) {
+					error = "Opening destination file failed";
+					return false;
+				}
+
+				stream_type stream([&file_out](const char* data, size_t length) {
+					file_out.write(data, length);
+					});
+
+				std::vector<char> buffer(1024 * 1024);
+
+				while (file_in) {
+					file_in.read(buffer.data(), buffer.size());
+					const auto read = file_in.gcount();
+
+					if (read > 0)
+						stream.update(buffer.data(), static_cast<size_t>(read));
+
+					if (!file_out) {
+						error = "Error writing destination file";
+						return false;
+					}
+				}
+
+				if (file_in.bad()) {
+					error = "Error reading source file";
+					return false;
+				}
+
+				stream.finalize();
+				file_out.close();
+
+				if (!file_out) {
+					error = "Error writing destination file";
+					return false;
+				}
+
+				return true;
+			}
+			catch (const std::exception& e) {
+				error = e.what();
+				return false;
+			}
+		}
+	}
+}
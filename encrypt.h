@@ -12,15 +12,22 @@
 
 #if defined(LECCORE_EXPORTS)
 #include "leccore.h"
+#include "executor.h"
 #else
 #include <liblec/leccore.h>
+#include <liblec/leccore/executor.h>
 #endif
 
 #include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
 
 namespace liblec {
 	namespace leccore {
 		/// <summary>256bit AES encryption class.</summary>
+		/// <remarks>The key schedule is expanded by each call, or once for a whole batch, and is not
+		/// kept in the object, so an object can be used from several threads at once.</remarks>
 		class leccore_api aes {
 		public:
 			/// <summary>Constructor.</summary>
@@ -36,20 +43,182 @@ namespace liblec {
 			/// <param name="error">Error information.</param>
 			/// <returns>Returns true if successful, else false.</returns>
 			[[nodiscard]]
+			bool encrypt(std::string_view input,
+				std::string& encrypted,
+				std::string& error);
+
+			/// <summary>Encrypt data.</summary>
+			/// <param name="input">The data to be encrypted.</param>
+			/// <param name="encrypted">The encrypted data.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Forwards to the string_view overload. Programs built against earlier
+			/// versions of the library import this one.</remarks>
+			[[nodiscard]]
 			bool encrypt(const std::string& input,
 				std::string& encrypted,
 				std::string& error);
 
+			/// <summary>Encrypt a null-terminated string.</summary>
+			/// <param name="input">The data to be encrypted.</param>
+			/// <param name="encrypted">The encrypted data.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>A string literal would otherwise match both of the overloads above.</remarks>
+			[[nodiscard]]
+			bool encrypt(const char* input,
+				std::string& encrypted,
+				std::string& error) {
+				return encrypt(std::string_view(input), encrypted, error);
+			}
+
+			/// <summary>Decrypt data.</summary>
+			/// <param name="input">The data to be decrypted.</param>
+			/// <param name="decrypted">The decrypted data.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			[[nodiscard]]
+			bool decrypt(std::string_view input,
+				std::string& decrypted,
+				std::string& error);
+
 			/// <summary>Decrypt data.</summary>
 			/// <param name="input">The data to be decrypted.</param>
 			/// <param name="decrypted">The decrypted data.</param>
 			/// <param name="error">Error information.</param>
 			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Forwards to the string_view overload. Programs built against earlier
+			/// versions of the library import this one.</remarks>
 			[[nodiscard]]
 			bool decrypt(const std::string& input,
 				std::string& decrypted,
 				std::string& error);
 
+			/// <summary>Decrypt a null-terminated string.</summary>
+			/// <param name="input">The data to be decrypted.</param>
+			/// <param name="decrypted">The decrypted data.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>A string literal would otherwise match both of the overloads above.</remarks>
+			[[nodiscard]]
+			bool decrypt(const char* input,
+				std::string& decrypted,
+				std::string& error) {
+				return decrypt(std::string_view(input), decrypted, error);
+			}
+
+			/// <summary>Get the size of the buffer that encryption needs.</summary>
+			/// <param name="length">The length of the data to be encrypted, in bytes.</param>
+			/// <returns>The length of the encrypted data, in bytes. The data is padded to a whole
+			/// number of 16 byte blocks, and always by at least one byte.</returns>
+			[[nodiscard]]
+			static size_t encrypted_size(size_t length);
+
+			/// <summary>Encrypt data into a caller-provided buffer.</summary>
+			/// <param name="data">A pointer to the data to be encrypted.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			/// <param name="encrypted">A buffer of at least <see cref="encrypted_size"></see> bytes
+			/// that receives the encrypted data.</param>
+			/// <param name="encrypted_length">The length of the encrypted data, in bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Nothing is allocated. The result is the same as that of the string overload.</remarks>
+			[[nodiscard]]
+			bool encrypt(const void* data,
+				size_t length,
+				unsigned char* encrypted,
+				size_t& encrypted_length,
+				std::string& error);
+
+			/// <summary>Decrypt data into a caller-provided buffer.</summary>
+			/// <param name="data">A pointer to the data to be decrypted.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			/// <param name="decrypted">A buffer of at least <see cref="length"></see> bytes that
+			/// receives the decrypted data.</param>
+			/// <param name="decrypted_length">The length of the decrypted data, in bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Nothing is allocated.</remarks>
+			[[nodiscard]]
+			bool decrypt(const void* data,
+				size_t length,
+				unsigned char* decrypted,
+				size_t& decrypted_length,
+				std::string& error);
+
+			/// <summary>Encrypt data in place.</summary>
+			/// <param name="buffer">A buffer with the data to be encrypted at its start. The data is
+			/// replaced by the encrypted data.</param>
+			/// <param name="buffer_size">The size of the buffer, in bytes. This must be at least
+			/// <see cref="encrypted_size"></see> of the length of the data, to leave room for the
+			/// padding.</param>
+			/// <param name="payload_length">The length of the data, in bytes.</param>
+			/// <param name="encrypted_length">The length of the encrypted data, in bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Nothing is allocated or copied. The result is the same as that of the other
+			/// overloads.</remarks>
+			[[nodiscard]]
+			bool encrypt_in_place(unsigned char* buffer,
+				size_t buffer_size,
+				size_t payload_length,
+				size_t& encrypted_length,
+				std::string& error);
+
+			/// <summary>Decrypt data in place.</summary>
+			/// <param name="buffer">A buffer with the encrypted data. The data is replaced by the
+			/// decrypted data, which starts at the beginning of the buffer.</param>
+			/// <param name="length">The length of the encrypted data, in bytes.</param>
+			/// <param name="decrypted_length">The length of the decrypted data, in bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false, in which case the contents of the
+			/// buffer are undefined.</returns>
+			/// <remarks>Nothing is allocated or copied.</remarks>
+			[[nodiscard]]
+			bool decrypt_in_place(unsigned char* buffer,
+				size_t length,
+				size_t& decrypted_length,
+				std::string& error);
+
+			/// <summary>Encrypt a batch of records, each with its own initialization vector.</summary>
+			/// <param name="records">The records to be encrypted.</param>
+			/// <param name="ivs">The initialization vectors, 16 bytes for each record, one after the
+			/// other. The initialization vector given to the constructor is not used.</param>
+			/// <param name="encrypted">The encrypted records, one after the other.</param>
+			/// <param name="offsets">The offsets of the encrypted records in
+			/// <see cref="encrypted"></see>. There is one more offset than there are records: record i
+			/// runs from offsets[i] to offsets[i + 1].</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Each record is encrypted exactly as the single-record overloads would encrypt
+			/// it with its initialization vector, but the key schedule is expanded and the output is
+			/// allocated once for the whole batch. Use this for large numbers of small records.</remarks>
+			[[nodiscard]]
+			bool encrypt_batch(const std::vector<std::string_view>& records,
+				const unsigned char* ivs,
+				std::string& encrypted,
+				std::vector<size_t>& offsets,
+				std::string& error);
+
+			/// <summary>Decrypt a batch of records encrypted by <see cref="encrypt_batch"></see>.</summary>
+			/// <param name="encrypted">The encrypted records, one after the other.</param>
+			/// <param name="offsets">The offsets of the encrypted records, as returned by
+			/// <see cref="encrypt_batch"></see>.</param>
+			/// <param name="ivs">The initialization vectors, 16 bytes for each record, one after the
+			/// other.</param>
+			/// <param name="decrypted">The decrypted records, one after the other.</param>
+			/// <param name="decrypted_offsets">The offsets of the decrypted records in
+			/// <see cref="decrypted"></see>, in the same form as <see cref="offsets"></see>.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if every record was decrypted, else false.</returns>
+			[[nodiscard]]
+			bool decrypt_batch(std::string_view encrypted,
+				const std::vector<size_t>& offsets,
+				const unsigned char* ivs,
+				std::string& decrypted,
+				std::vector<size_t>& decrypted_offsets,
+				std::string& error);
+
 		private:
 			class impl;
 			impl& _d;
@@ -59,5 +228,643 @@ namespace liblec {
 			aes(const aes&) = delete;
 			aes& operator=(const aes&) = delete;
 		};
+
+		/// <summary>256bit AES-CTR encryption class for large in-memory buffers.</summary>
+		/// <remarks>In CTR mode every 16 byte block is encrypted independently of the others, so a
+		/// large buffer is split into ranges that are encrypted on all the processors at once, in
+		/// place. Encryption and decryption are the same operation. CTR mode does not detect
+		/// tampering; use <see cref="aes_gcm"></see> where that matters. Each range is encrypted with
+		/// cipher objects of its own, so an object can be used from several threads at once.</remarks>
+		class leccore_api aes_ctr {
+		public:
+			/// <summary>The size of the key, in bytes.</summary>
+			static constexpr size_t key_size = 32;
+
+			/// <summary>The size of the initial counter block, in bytes.</summary>
+			static constexpr size_t iv_size = 16;
+
+			/// <summary>Constructor.</summary>
+			/// <param name="key">The key to use. This must be kept private. Only the first
+			/// <see cref="key_size"></see> bytes are used, and a shorter key is padded with
+			/// zeros.</param>
+			/// <param name="max_threads">The maximum number of threads to encrypt a buffer on, the
+			/// calling thread included; use 0 for one per logical processor.</param>
+			aes_ctr(const std::string& key,
+				unsigned int max_threads = 0);
+			~aes_ctr();
+
+			/// <summary>Encrypt data in place.</summary>
+			/// <param name="iv">The <see cref="iv_size"></see> byte initial counter block. The counter
+			/// is incremented as a 128 bit big-endian number for each block, and no counter value may
+			/// ever be used twice with the same key.</param>
+			/// <param name="data">A pointer to the data, which is replaced by the encrypted data.</param>
+			/// <param name="length">The length of the data, in bytes. It need not be a multiple of
+			/// 16.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			[[nodiscard]]
+			bool encrypt(const unsigned char* iv,
+				void* data,
+				size_t length,
+				std::string& error);
+
+			/// <summary>Decrypt data in place.</summary>
+			/// <param name="iv">The initial counter block the data was encrypted with.</param>
+			/// <param name="data">A pointer to the encrypted data, which is replaced by the decrypted
+			/// data.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			[[nodiscard]]
+			bool decrypt(const unsigned char* iv,
+				void* data,
+				size_t length,
+				std::string& error);
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Default constructor and copying an object of this class are not allowed.
+			aes_ctr() = delete;
+			aes_ctr(const aes_ctr&) = delete;
+			aes_ctr& operator=(const aes_ctr&) = delete;
+		};
+
+		/// <summary>256bit AES-GCM authenticated encryption class.</summary>
+		/// <remarks>Encryption and authentication are done in a single pass, using the processor's
+		/// AES and carry-less multiply instructions where they are available, so no separate MAC
+		/// is needed. An object is not safe to use from several threads at once; use an object per
+		/// thread.</remarks>
+		class leccore_api aes_gcm {
+		public:
+			/// <summary>The size of the key, in bytes.</summary>
+			static constexpr size_t key_size = 32;
+
+			/// <summary>The size of the nonce, in bytes.</summary>
+			static constexpr size_t nonce_size = 12;
+
+			/// <summary>The size of the authentication tag, in bytes.</summary>
+			static constexpr size_t tag_size = 16;
+
+			/// <summary>Constructor.</summary>
+			/// <param name="key">The key to use. This must be kept private. Only the first
+			/// <see cref="key_size"></see> bytes are used, and a shorter key is padded with
+			/// zeros.</param>
+			/// <remarks>The key schedule and the authentication tables are computed once, here.</remarks>
+			aes_gcm(const std::string& key);
+			~aes_gcm();
+
+			/// <summary>Encrypt and authenticate data with an explicit nonce.</summary>
+			/// <param name="nonce">The <see cref="nonce_size"></see> byte nonce. It must never be
+			/// used twice with the same key.</param>
+			/// <param name="data">A pointer to the data to be encrypted.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			/// <param name="associated_data">Data that is authenticated but not encrypted, e.g. a
+			/// header. It can be empty.</param>
+			/// <param name="encrypted">A buffer of at least <see cref="length"></see> bytes that
+			/// receives the encrypted data. It can be the same as <see cref="data"></see>.</param>
+			/// <param name="tag">A buffer of <see cref="tag_size"></see> bytes that receives the
+			/// authentication tag.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			[[nodiscard]]
+			bool encrypt(const unsigned char* nonce,
+				const void* data,
+				size_t length,
+				std::string_view associated_data,
+				unsigned char* encrypted,
+				unsigned char* tag,
+				std::string& error);
+
+			/// <summary>Verify and decrypt data with an explicit nonce.</summary>
+			/// <param name="nonce">The nonce the data was encrypted with.</param>
+			/// <param name="data">A pointer to the encrypted data.</param>
+			/// <param name="length">The length of the encrypted data, in bytes.</param>
+			/// <param name="associated_data">The associated data the data was encrypted with.</param>
+			/// <param name="tag">The <see cref="tag_size"></see> byte authentication tag.</param>
+			/// <param name="decrypted">A buffer of at least <see cref="length"></see> bytes that
+			/// receives the decrypted data. It can be the same as <see cref="data"></see>.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false. If the data, the associated data or
+			/// the tag have been tampered with false is returned and the buffer is cleared.</returns>
+			[[nodiscard]]
+			bool decrypt(const unsigned char* nonce,
+				const void* data,
+				size_t length,
+				std::string_view associated_data,
+				const unsigned char* tag,
+				unsigned char* decrypted,
+				std::string& error);
+
+			/// <summary>Encrypt and authenticate data with a random nonce.</summary>
+			/// <param name="input">The data to be encrypted.</param>
+			/// <param name="encrypted">The nonce, followed by the encrypted data, followed by the
+			/// tag. This is <see cref="nonce_size"></see> + <see cref="tag_size"></see> bytes
+			/// longer than the input.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>The nonce is drawn from <see cref="hash_string::random_bytes"></see>.</remarks>
+			[[nodiscard]]
+			bool encrypt(std::string_view input,
+				std::string& encrypted,
+				std::string& error);
+
+			/// <summary>Verify and decrypt data encrypted by the overload above.</summary>
+			/// <param name="input">The nonce, encrypted data and tag.</param>
+			/// <param name="decrypted">The decrypted data.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			[[nodiscard]]
+			bool decrypt(std::string_view input,
+				std::string& decrypted,
+				std::string& error);
+
+			/// <summary>Encrypt and authenticate data in place, with a random nonce.</summary>
+			/// <param name="buffer">A buffer laid out like the output of the string overload: room
+			/// for the nonce, then the data to be encrypted, then room for the tag. The nonce and the
+			/// tag are written into their places and the data is replaced by the encrypted data.</param>
+			/// <param name="buffer_size">The size of the buffer, in bytes. This must be at least
+			/// <see cref="nonce_size"></see> + payload_length + <see cref="tag_size"></see>.</param>
+			/// <param name="payload_length">The length of the data, which starts
+			/// <see cref="nonce_size"></see> bytes into the buffer.</param>
+			/// <param name="encrypted_length">The length of the nonce, encrypted data and tag, in
+			/// bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Nothing is allocated or copied. The result is the same as that of the string
+			/// overload.</remarks>
+			[[nodiscard]]
+			bool encrypt_in_place(unsigned char* buffer,
+				size_t buffer_size,
+				size_t payload_length,
+				size_t& encrypted_length,
+				std::string& error);
+
+			/// <summary>Verify and decrypt data in place.</summary>
+			/// <param name="buffer">A buffer with the nonce, encrypted data and tag, as made by
+			/// <see cref="encrypt_in_place"></see> or the string overload. The encrypted data is
+			/// replaced by the decrypted data, which starts <see cref="nonce_size"></see> bytes into
+			/// the buffer.</param>
+			/// <param name="length">The length of the nonce, encrypted data and tag, in bytes.</param>
+			/// <param name="decrypted_length">The length of the decrypted data, in bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false. If the data has been tampered with
+			/// false is returned and the data is cleared.</returns>
+			/// <remarks>Nothing is allocated or copied.</remarks>
+			[[nodiscard]]
+			bool decrypt_in_place(unsigned char* buffer,
+				size_t length,
+				size_t& decrypted_length,
+				std::string& error);
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Default constructor and copying an object of this class are not allowed.
+			aes_gcm() = delete;
+			aes_gcm(const aes_gcm&) = delete;
+			aes_gcm& operator=(const aes_gcm&) = delete;
+		};
+
+		/// <summary>ChaCha20-Poly1305 authenticated encryption class.</summary>
+		/// <remarks>Use this instead of <see cref="aes_gcm"></see> on processors without AES
+		/// instructions, where it is several times faster than AES in software. ChaCha20 runs on
+		/// SSE2 or AVX2, whichever the processor has. An object is not safe to use from several
+		/// threads at once; use an object per thread.</remarks>
+		class leccore_api chacha20_poly1305 {
+		public:
+			/// <summary>The size of the key, in bytes.</summary>
+			static constexpr size_t key_size = 32;
+
+			/// <summary>The size of the nonce, in bytes.</summary>
+			static constexpr size_t nonce_size = 12;
+
+			/// <summary>The size of the authentication tag, in bytes.</summary>
+			static constexpr size_t tag_size = 16;
+
+			/// <summary>Constructor.</summary>
+			/// <param name="key">The key to use. This must be kept private. Only the first
+			/// <see cref="key_size"></see> bytes are used, and a shorter key is padded with
+			/// zeros.</param>
+			chacha20_poly1305(const std::string& key);
+			~chacha20_poly1305();
+
+			/// <summary>Encrypt and authenticate data with an explicit nonce.</summary>
+			/// <param name="nonce">The <see cref="nonce_size"></see> byte nonce. It must never be
+			/// used twice with the same key.</param>
+			/// <param name="data">A pointer to the data to be encrypted.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			/// <param name="associated_data">Data that is authenticated but not encrypted, e.g. a
+			/// header. It can be empty.</param>
+			/// <param name="encrypted">A buffer of at least <see cref="length"></see> bytes that
+			/// receives the encrypted data. It can be the same as <see cref="data"></see>.</param>
+			/// <param name="tag">A buffer of <see cref="tag_size"></see> bytes that receives the
+			/// authentication tag.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			[[nodiscard]]
+			bool encrypt(const unsigned char* nonce,
+				const void* data,
+				size_t length,
+				std::string_view associated_data,
+				unsigned char* encrypted,
+				unsigned char* tag,
+				std::string& error);
+
+			/// <summary>Verify and decrypt data with an explicit nonce.</summary>
+			/// <param name="nonce">The nonce the data was encrypted with.</param>
+			/// <param name="data">A pointer to the encrypted data.</param>
+			/// <param name="length">The length of the encrypted data, in bytes.</param>
+			/// <param name="associated_data">The associated data the data was encrypted with.</param>
+			/// <param name="tag">The <see cref="tag_size"></see> byte authentication tag.</param>
+			/// <param name="decrypted">A buffer of at least <see cref="length"></see> bytes that
+			/// receives the decrypted data. It can be the same as <see cref="data"></see>.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false. If the data, the associated data or
+			/// the tag have been tampered with false is returned and the buffer is cleared.</returns>
+			[[nodiscard]]
+			bool decrypt(const unsigned char* nonce,
+				const void* data,
+				size_t length,
+				std::string_view associated_data,
+				const unsigned char* tag,
+				unsigned char* decrypted,
+				std::string& error);
+
+			/// <summary>Encrypt and authenticate data with a random nonce.</summary>
+			/// <param name="input">The data to be encrypted.</param>
+			/// <param name="encrypted">The nonce, followed by the encrypted data, followed by the
+			/// tag. This is <see cref="nonce_size"></see> + <see cref="tag_size"></see> bytes
+			/// longer than the input.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>The nonce is drawn from <see cref="hash_string::random_bytes"></see>.</remarks>
+			[[nodiscard]]
+			bool encrypt(std::string_view input,
+				std::string& encrypted,
+				std::string& error);
+
+			/// <summary>Verify and decrypt data encrypted by the overload above.</summary>
+			/// <param name="input">The nonce, encrypted data and tag.</param>
+			/// <param name="decrypted">The decrypted data.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			[[nodiscard]]
+			bool decrypt(std::string_view input,
+				std::string& decrypted,
+				std::string& error);
+
+			/// <summary>Encrypt and authenticate data in place, with a random nonce.</summary>
+			/// <param name="buffer">A buffer laid out like the output of the string overload: room
+			/// for the nonce, then the data to be encrypted, then room for the tag. The nonce and the
+			/// tag are written into their places and the data is replaced by the encrypted data.</param>
+			/// <param name="buffer_size">The size of the buffer, in bytes. This must be at least
+			/// <see cref="nonce_size"></see> + payload_length + <see cref="tag_size"></see>.</param>
+			/// <param name="payload_length">The length of the data, which starts
+			/// <see cref="nonce_size"></see> bytes into the buffer.</param>
+			/// <param name="encrypted_length">The length of the nonce, encrypted data and tag, in
+			/// bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Nothing is allocated or copied. The result is the same as that of the string
+			/// overload.</remarks>
+			[[nodiscard]]
+			bool encrypt_in_place(unsigned char* buffer,
+				size_t buffer_size,
+				size_t payload_length,
+				size_t& encrypted_length,
+				std::string& error);
+
+			/// <summary>Verify and decrypt data in place.</summary>
+			/// <param name="buffer">A buffer with the nonce, encrypted data and tag, as made by
+			/// <see cref="encrypt_in_place"></see> or the string overload. The encrypted data is
+			/// replaced by the decrypted data, which starts <see cref="nonce_size"></see> bytes into
+			/// the buffer.</param>
+			/// <param name="length">The length of the nonce, encrypted data and tag, in bytes.</param>
+			/// <param name="decrypted_length">The length of the decrypted data, in bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false. If the data has been tampered with
+			/// false is returned and the data is cleared.</returns>
+			/// <remarks>Nothing is allocated or copied.</remarks>
+			[[nodiscard]]
+			bool decrypt_in_place(unsigned char* buffer,
+				size_t length,
+				size_t& decrypted_length,
+				std::string& error);
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Default constructor and copying an object of this class are not allowed.
+			chacha20_poly1305() = delete;
+			chacha20_poly1305(const chacha20_poly1305&) = delete;
+			chacha20_poly1305& operator=(const chacha20_poly1305&) = delete;
+		};
+
+		/// <summary>Authenticated encryption ciphers.</summary>
+		enum class cipher {
+			/// <summary>AES-256-GCM, see <see cref="aes_gcm"></see>.</summary>
+			aes_gcm,
+
+			/// <summary>ChaCha20-Poly1305, see <see cref="chacha20_poly1305"></see>.</summary>
+			chacha20_poly1305,
+		};
+
+		/// <summary>Get the fastest authenticated encryption cipher on this processor.</summary>
+		/// <returns>The recommended cipher, as defined in <see cref="cipher"></see>.</returns>
+		/// <remarks>AES-GCM is recommended when the processor has the AES and carry-less multiply
+		/// instructions, and ChaCha20-Poly1305 otherwise. Both ends of a connection or of stored
+		/// data must of course agree on the cipher.</remarks>
+		[[nodiscard]]
+		cipher leccore_api recommended_cipher();
+
+		/// <summary>Chunked authenticated encryption of data of any length, in constant memory.</summary>
+		/// <remarks>The data is split into chunks that are each encrypted and authenticated with
+		/// <see cref="aes_gcm"></see> or <see cref="chacha20_poly1305"></see>, behind a
+		/// <see cref="header_size"></see> byte header that records the cipher and the chunk size. Only
+		/// one chunk is held in memory at a time, however long the data. Each chunk's nonce is derived
+		/// from a random prefix in the header, the chunk's position and whether it is the last chunk, so
+		/// chunks that are reordered, dropped or cut off are detected on decryption. Decrypt with
+		/// <see cref="decrypt_stream"></see> or <see cref="decrypt_file"></see>.</remarks>
+		class leccore_api encrypt_stream {
+		public:
+			/// <summary>A function that receives the encrypted data, piece by piece.</summary>
+			using sink = std::function<void(const char* data, size_t length)>;
+
+			/// <summary>The size of the header, in bytes.</summary>
+			static constexpr size_t header_size = 16;
+
+			/// <summary>The size of the authentication tag that follows each chunk, in bytes.</summary>
+			static constexpr size_t tag_size = 16;
+
+			/// <summary>The default chunk size, in bytes.</summary>
+			static constexpr size_t default_chunk_size = 1024 * 1024;
+
+			/// <summary>The smallest chunk size, in bytes.</summary>
+			static constexpr size_t min_chunk_size = 1024;
+
+			/// <summary>The largest chunk size, in bytes.</summary>
+			static constexpr size_t max_chunk_size = 64 * 1024 * 1024;
+
+			/// <summary>Constructor.</summary>
+			/// <param name="key">The key to use. This must be kept private. Only the first 32 bytes
+			/// are used, and a shorter key is padded with zeros.</param>
+			/// <param name="output">The function to send the encrypted data to.</param>
+			/// <param name="algorithm">The cipher, as defined in <see cref="cipher"></see>.</param>
+			/// <param name="chunk_size">The chunk size, in bytes, from <see cref="min_chunk_size"></see>
+			/// to <see cref="max_chunk_size"></see>. Smaller chunks suit data that is sent over a
+			/// network as it is produced.</param>
+			encrypt_stream(const std::string& key,
+				sink output,
+				cipher algorithm = recommended_cipher(),
+				size_t chunk_size = default_chunk_size);
+			~encrypt_stream();
+
+			/// <summary>Add data to be encrypted.</summary>
+			/// <param name="data">A pointer to the data.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Data is sent to the sink a chunk at a time, so a call may send nothing.</remarks>
+			[[nodiscard]]
+			bool update(const void* data,
+				size_t length,
+				std::string& error);
+
+			/// <summary>Encrypt the remaining data and send it to the sink.</summary>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Call this exactly once, after the last call to <see cref="update"></see>.</remarks>
+			[[nodiscard]]
+			bool finalize(std::string& error);
+
+			/// <summary>Get the size of the encrypted data.</summary>
+			/// <param name="length">The length of the data to be encrypted, in bytes.</param>
+			/// <param name="chunk_size">The chunk size, in bytes.</param>
+			/// <returns>The length of the encrypted data, in bytes.</returns>
+			[[nodiscard]]
+			static unsigned long long encrypted_size(unsigned long long length,
+				size_t chunk_size = default_chunk_size);
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Default constructor and copying an object of this class are not allowed.
+			encrypt_stream() = delete;
+			encrypt_stream(const encrypt_stream&) = delete;
+			encrypt_stream& operator=(const encrypt_stream&) = delete;
+		};
+
+		/// <summary>Decryption of data encrypted by <see cref="encrypt_stream"></see>, in constant
+		/// memory.</summary>
+		/// <remarks>The cipher and the chunk size are read from the header. Each chunk is verified
+		/// before it is sent to the sink, so only authentic data is ever sent, but whether the data
+		/// is complete is only known when <see cref="finalize"></see> succeeds. Discard everything
+		/// the sink received if it does not.</remarks>
+		class leccore_api decrypt_stream {
+		public:
+			/// <summary>A function that receives the decrypted data, piece by piece.</summary>
+			using sink = std::function<void(const char* data, size_t length)>;
+
+			/// <summary>Constructor.</summary>
+			/// <param name="key">The key the data was encrypted with.</param>
+			/// <param name="output">The function to send the decrypted data to.</param>
+			decrypt_stream(const std::string& key,
+				sink output);
+			~decrypt_stream();
+
+			/// <summary>Add encrypted data.</summary>
+			/// <param name="data">A pointer to the data.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false. If a chunk has been tampered with
+			/// false is returned and the error is "Authentication failed".</returns>
+			[[nodiscard]]
+			bool update(const void* data,
+				size_t length,
+				std::string& error);
+
+			/// <summary>Decrypt the remaining data and send it to the sink.</summary>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if all the data was decrypted, else false, e.g. if the data
+			/// was cut short.</returns>
+			/// <remarks>Call this exactly once, after the last call to <see cref="update"></see>.</remarks>
+			[[nodiscard]]
+			bool finalize(std::string& error);
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Default constructor and copying an object of this class are not allowed.
+			decrypt_stream() = delete;
+			decrypt_stream(const decrypt_stream&) = delete;
+			decrypt_stream& operator=(const decrypt_stream&) = delete;
+		};
+
+		/// <summary>File encryption class. Encrypts a file of any size into the format of
+		/// <see cref="encrypt_stream"></see>, holding no more than a few chunks in memory.</summary>
+		/// <remarks>The file is read and written with overlapped I/O, so while one chunk is being
+		/// encrypted the next is being read and the previous one written.</remarks>
+		class leccore_api encrypt_file {
+		public:
+			/// <summary>Constructor.</summary>
+			/// <param name="key">The key to use. This must be kept private. Only the first 32 bytes
+			/// are used, and a shorter key is padded with zeros.</param>
+			/// <param name="algorithm">The cipher, as defined in <see cref="cipher"></see>.</param>
+			encrypt_file(const std::string& key,
+				cipher algorithm = recommended_cipher());
+			~encrypt_file();
+
+			/// <summary>Progress of the operation.</summary>
+			using progress_info = struct {
+				/// <summary>The size of the source file, in bytes.</summary>
+				unsigned long long total;
+
+				/// <summary>The number of bytes of the source file processed so far.</summary>
+				unsigned long long processed;
+			};
+
+			/// <summary>Start encrypting.</summary>
+			/// <param name="source">The full path to the file to encrypt.</param>
+			/// <param name="destination">The full path to the encrypted file. It is overwritten if it
+			/// exists, and deleted if encryption fails or is cancelled.</param>
+			/// <remarks>This method returns almost immediately. The actual encryption is executed
+			/// on a different thread. To check the status of the encryption use the
+			/// <see cref="encrypting"></see> method.</remarks>
+			void start(const std::string& source,
+				const std::string& destination);
+
+			/// <summary>Check whether encryption is still in progress.</summary>
+			/// <returns>Returns true if encryption is still underway and false otherwise.</returns>
+			bool encrypting();
+
+			/// <summary>Check whether encryption is still in progress.</summary>
+			/// <param name="progress">The progress, as defined in <see cref="progress_info"></see>.</param>
+			/// <returns>Returns true if encryption is still underway and false otherwise.</returns>
+			bool encrypting(progress_info& progress);
+
+			/// <summary>Get the result of the encryption.</summary>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if the file was encrypted, else false.</returns>
+			bool result(std::string& error);
+
+			/// <summary>Set a function to be called when encryption completes.</summary>
+			/// <param name="callback">The function to call. It is called on the thread that did the
+			/// encryption, right after the result becomes available, so it can call
+			/// <see cref="result"></see>.</param>
+			/// <remarks>Set the callback before calling <see cref="start"></see>.</remarks>
+			void on_complete(std::function<void()> callback);
+
+			/// <summary>Wait for encryption to complete.</summary>
+			/// <param name="timeout_milliseconds">The maximum time to wait, in milliseconds.</param>
+			/// <returns>Returns true if encryption is complete, else false if the timeout elapsed first.</returns>
+			bool wait(unsigned long long timeout_milliseconds);
+
+			/// <summary>Get the completion event.</summary>
+			/// <returns>A handle to a manual-reset Win32 event object (HANDLE) that is signaled when
+			/// encryption completes. The handle is owned by this object; do not close it.</returns>
+			void* completion_event();
+
+			/// <summary>Cancel encryption.</summary>
+			/// <remarks>This method returns immediately. Encryption stops before the next chunk and
+			/// <see cref="result"></see> then returns false with the error "Operation cancelled".
+			/// Destroying this object also cancels any operation that is still underway.</remarks>
+			void cancel();
+
+			/// <summary>Set a cancellation token to observe in addition to <see cref="cancel"></see>.</summary>
+			/// <param name="token">The token, as defined in <see cref="cancellation_token"></see>.</param>
+			/// <remarks>The token applies to operations started after this call.</remarks>
+			void set_cancellation_token(const cancellation_token& token);
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Default constructor and copying an object of this class are not allowed.
+			encrypt_file() = delete;
+			encrypt_file(const encrypt_file&) = delete;
+			encrypt_file& operator=(const encrypt_file&) = delete;
+		};
+
+		/// <summary>File decryption class. Decrypts a file encrypted by <see cref="encrypt_file"></see>
+		/// or <see cref="encrypt_stream"></see>, holding no more than a few chunks in memory.</summary>
+		/// <remarks>The file is read and written with overlapped I/O, so while one chunk is being
+		/// decrypted the next is being read and the previous one written.</remarks>
+		class leccore_api decrypt_file {
+		public:
+			/// <summary>Constructor.</summary>
+			/// <param name="key">The key the file was encrypted with.</param>
+			decrypt_file(const std::string& key);
+			~decrypt_file();
+
+			/// <summary>Start decrypting.</summary>
+			/// <param name="source">The full path to the encrypted file.</param>
+			/// <param name="destination">The full path to the decrypted file. It is overwritten if it
+			/// exists, and deleted if decryption fails or is cancelled, so that no partial or
+			/// tampered data is left behind.</param>
+			/// <remarks>This method returns almost immediately. The actual decryption is executed
+			/// on a different thread. To check the status of the decryption use the
+			/// <see cref="decrypting"></see> method.</remarks>
+			void start(const std::string& source,
+				const std::string& destination);
+
+			/// <summary>Check whether decryption is still in progress.</summary>
+			/// <returns>Returns true if decryption is still underway and false otherwise.</returns>
+			bool decrypting();
+
+			/// <summary>Check whether decryption is still in progress.</summary>
+			/// <param name="progress">The progress, as defined in
+			/// <see cref="encrypt_file::progress_info"></see>.</param>
+			/// <returns>Returns true if decryption is still underway and false otherwise.</returns>
+			bool decrypting(encrypt_file::progress_info& progress);
+
+			/// <summary>Get the result of the decryption.</summary>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if the file was decrypted, else false. If the file has been
+			/// tampered with the error is "Authentication failed".</returns>
+			bool result(std::string& error);
+
+			/// <summary>Set a function to be called when decryption completes.</summary>
+			/// <param name="callback">The function to call. It is called on the thread that did the
+			/// decryption, right after the result becomes available, so it can call
+			/// <see cref="result"></see>.</param>
+			/// <remarks>Set the callback before calling <see cref="start"></see>.</remarks>
+			void on_complete(std::function<void()> callback);
+
+			/// <summary>Wait for decryption to complete.</summary>
+			/// <param name="timeout_milliseconds">The maximum time to wait, in milliseconds.</param>
+			/// <returns>Returns true if decryption is complete, else false if the timeout elapsed first.</returns>
+			bool wait(unsigned long long timeout_milliseconds);
+
+			/// <summary>Get the completion event.</summary>
+			/// <returns>A handle to a manual-reset Win32 event object (HANDLE) that is signaled when
+			/// decryption completes. The handle is owned by this object; do not close it.</returns>
+			void* completion_event();
+
+			/// <summary>Cancel decryption.</summary>
+			/// <remarks>This method returns immediately. Decryption stops before the next chunk and
+			/// <see cref="result"></see> then returns false with the error "Operation cancelled".
+			/// Destroying this object also cancels any operation that is still underway.</remarks>
+			void cancel();
+
+			/// <summary>Set a cancellation token to observe in addition to <see cref="cancel"></see>.</summary>
+			/// <param name="token">The token, as defined in <see cref="cancellation_token"></see>.</param>
+			/// <remarks>The token applies to operations started after this call.</remarks>
+			void set_cancellation_token(const cancellation_token& token);
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Default constructor and copying an object of this class are not allowed.
+			decrypt_file() = delete;
+			decrypt_file(const decrypt_file&) = delete;
+			decrypt_file& operator=(const decrypt_file&) = delete;
+		};
 	}
 }
@@ -0,0 +1,205 @@
+//
+// aead.h - authenticated encryption with associated data, common implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include "../hash.h"
+
+#include <cryptlib.h>
+#include <misc.h>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <algorithm>
+
+namespace liblec {
+	namespace leccore {
+		// The implementation shared by aes_gcm and chacha20_poly1305. The cipher objects are keyed
+		// once, in the constructor, and each message only resynchronizes them with its nonce.
+		template <typename encryption_type, typename decryption_type,
+			size_t key_size, size_t nonce_size, size_t tag_size>
+		class aead {
+			encryption_type _encryption;
+			decryption_type _decryption;
+
+		public:
+			aead(const std::string& key) {
+				CryptoPP::byte key_bytes[key_size];
+				memset(key_bytes, 0, sizeof(key_bytes));
+				memcpy(key_bytes, key.data(), (std::min)(key.size(), sizeof(key_bytes)));
+
+				// Crypto++ insists on an IV when keying; each message replaces it with its own nonce
+				const CryptoPP::byte nonce[nonce_size] = {};
+				_encryption.SetKeyWithIV(key_bytes, sizeof(key_bytes), nonce, sizeof(nonce));
+				_decryption.SetKeyWithIV(key_bytes, sizeof(key_bytes), nonce, sizeof(nonce));
+
+				CryptoPP::SecureWipeArray(key_bytes, sizeof(key_bytes));
+			}
+
+			bool encrypt(const unsigned char* nonce,
+				const void* data, size_t length,
+				std::string_view associated_data,
+				unsigned char* encrypted, unsigned char* tag,
+				std::string& error) {
+				error.clear();
+				try {
+					_encryption.EncryptAndAuthenticate(encrypted, tag, tag_size,
+						nonce, static_cast<int>(nonce_size),
+						reinterpret_cast<const CryptoPP::byte*>(associated_data.data()), associated_data.size(),
+						reinterpret_cast<const CryptoPP::byte*>(data), length);
+					return true;
+				}
+				catch (CryptoPP::Exception& e) {
+					error = e.what();
+					return false;
+				}
+				catch (const std::exception& e) {
+					error = e.what();
+					return false;
+				}
+			}
+
+			bool decrypt(const unsigned char* nonce,
+				const void* data, size_t length,
+				std::string_view associated_data,
+				const unsigned char* tag,
+				unsigned char* decrypted,
+				std::string& error) {
+				error.clear();
+				try {
+					if (!_decryption.DecryptAndVerify(decrypted, tag, tag_size,
+						nonce, static_cast<int>(nonce_size),
+						reinterpret_cast<const CryptoPP::byte*>(associated_data.data()), associated_data.size(),
+						reinterpret_cast<const CryptoPP::byte*>(data), length)) {
+						// nothing of data that failed authentication is handed out
+						CryptoPP::SecureWipeArray(decrypted, length);
+						error = "Authentication failed";
+						return false;
+					}
+
+					return true;
+				}
+				catch (CryptoPP::Exception& e) {
+					error = e.what();
+					return false;
+				}
+				catch (const std::exception& e) {
+					error = e.what();
+					return false;
+				}
+			}
+
+			// a random nonce, followed by the encrypted data, followed by the tag
+			bool encrypt(std::string_view input,
+				std::string& encrypted, std::string& error) {
+				error.clear();
+				encrypted.clear();
+				try {
+					encrypted.resize(nonce_size + input.size() + tag_size);
+					unsigned char* p_nonce = reinterpret_cast<unsigned char*>(&encrypted[0]);
+
+					if (!hash_string::random_bytes(p_nonce, nonce_size)) {
+						encrypted.clear();
+						error = "Generating the nonce failed";
+						return false;
+					}
+
+					if (!encrypt(p_nonce, input.data(), input.size(), std::string_view(),
+						p_nonce + nonce_size, p_nonce + nonce_size + input.size(), error)) {
+						encrypted.clear();
+						return false;
+					}
+
+					return true;
+				}
+				catch (const std::exception& e) {
+					error = e.what();
+					return false;
+				}
+			}
+
+			// the same layout as above, with the data already in its place in the buffer
+			bool encrypt_in_place(unsigned char* buffer, size_t buffer_size,
+				size_t payload_length, size_t& encrypted_length, std::string& error) {
+				error.clear();
+				encrypted_length = 0;
+
+				if (buffer_size < nonce_size || buffer_size - nonce_size < tag_size ||
+					buffer_size - nonce_size - tag_size < payload_length) {
+					error = "Buffer too small";
+					return false;
+				}
+
+				if (!hash_string::random_bytes(buffer, nonce_size)) {
+					error = "Generating the nonce failed";
+					return false;
+				}
+
+				unsigned char* p_payload = buffer + nonce_size;
+
+				if (!encrypt(buffer, p_payload, payload_length, std::string_view(),
+					p_payload, p_payload + payload_length, error))
+					return false;
+
+				encrypted_length = nonce_size + payload_length + tag_size;
+				return true;
+			}
+
+			bool decrypt_in_place(unsigned char* buffer, size_t length,
+				size_t& decrypted_length, std::string& error) {
+				error.clear();
+				decrypted_length = 0;
+
+				if (length < nonce_size + tag_size) {
+					error = "Invalid ciphertext length";
+					return false;
+				}
+
+				unsigned char* p_payload = buffer + nonce_size;
+				const size_t payload_length = length - nonce_size - tag_size;
+
+				if (!decrypt(buffer, p_payload, payload_length, std::string_view(),
+					p_payload + payload_length, p_payload, error))
+					return false;
+
+				decrypted_length = payload_length;
+				return true;
+			}
+
+			bool decrypt(std::string_view input,
+				std::string& decrypted, std::string& error) {
+				error.clear();
+				decrypted.clear();
+				try {
+					if (input.size() < nonce_size + tag_size) {
+						error = "Invalid ciphertext length";
+						return false;
+					}
+
+					const unsigned char* p_nonce = reinterpret_cast<const unsigned char*>(input.data());
+					const size_t length = input.size() - nonce_size - tag_size;
+					decrypted.resize(length);
+
+					if (!decrypt(p_nonce, p_nonce + nonce_size, length, std::string_view(),
+						p_nonce + nonce_size + length, reinterpret_cast<unsigned char*>(&decrypted[0]), error)) {
+						decrypted.clear();
+						return false;
+					}
+
+					return true;
+				}
+				catch (const std::exception& e) {
+					error = e.what();
+					return false;
+				}
+			}
+		};
+	}
+}
@@ -13,6 +13,8 @@
 #include <aes.h>
 #include <hex.h>
 #include <modes.h>
+#include <misc.h>
+#include <cstring>
 
 using namespace liblec::leccore;
 
@@ -39,53 +41,293 @@ public:
 			iv = iv.substr(0, max_iv_string_length);	// trim
 		memcpy(_iv, iv.c_str(), iv.size());
 	}
-	~impl() {}
+	~impl() {
+		CryptoPP::SecureWipeArray(_key, sizeof(_key));
+	}
+
+	// the key schedules are expanded by each call, or once for a whole batch, and never kept in
+	// the object: Crypto++ block ciphers write scratch data while processing, so a cipher object
+	// cannot be shared between threads
+	void expand(CryptoPP::AES::Encryption& aesEncryption) const {
+		aesEncryption.SetKey(_key, CryptoPP::AES::MAX_KEYLENGTH);
+	}
+	void expand(CryptoPP::AES::Decryption& aesDecryption) const {
+		aesDecryption.SetKey(_key, CryptoPP::AES::MAX_KEYLENGTH);
+	}
+
+	// encrypt a message with PKCS #7 padding into encrypted_size(length) bytes
+	static void encrypt(CryptoPP::AES::Encryption& aesEncryption,
+		const CryptoPP::byte* iv, const void* data, size_t length,
+		unsigned char* encrypted, size_t& encrypted_length) {
+		CryptoPP::CBC_Mode_ExternalCipher::Encryption cbcEncryption(aesEncryption, iv);
+
+		// the whole blocks, then the last block with the padding
+		const size_t whole = length / CryptoPP::AES::BLOCKSIZE * CryptoPP::AES::BLOCKSIZE;
+		const size_t remainder = length - whole;
+
+		if (whole)
+			cbcEncryption.ProcessData(encrypted, reinterpret_cast<const CryptoPP::byte*>(data), whole);
+
+		CryptoPP::byte last[CryptoPP::AES::BLOCKSIZE];
+		memcpy(last, reinterpret_cast<const CryptoPP::byte*>(data) + whole, remainder);
+		memset(last + remainder, static_cast<int>(CryptoPP::AES::BLOCKSIZE - remainder),
+			CryptoPP::AES::BLOCKSIZE - remainder);
+
+		cbcEncryption.ProcessData(encrypted + whole, last, CryptoPP::AES::BLOCKSIZE);
+		CryptoPP::SecureWipeArray(last, sizeof(last));
+
+		encrypted_length = whole + CryptoPP::AES::BLOCKSIZE;
+	}
+
+	// decrypt a message and strip its PKCS #7 padding
+	static bool decrypt(CryptoPP::AES::Decryption& aesDecryption,
+		const CryptoPP::byte* iv, const void* data, size_t length,
+		unsigned char* decrypted, size_t& decrypted_length, std::string& error) {
+		if (length == 0 || length % CryptoPP::AES::BLOCKSIZE) {
+			error = "Invalid ciphertext length";
+			return false;
+		}
+
+		CryptoPP::CBC_Mode_ExternalCipher::Decryption cbcDecryption(aesDecryption, iv);
+		cbcDecryption.ProcessData(decrypted, reinterpret_cast<const CryptoPP::byte*>(data), length);
+
+		// check and strip the PKCS #7 padding
+		const unsigned int padding = decrypted[length - 1];
+		bool valid = padding >= 1 && padding <= CryptoPP::AES::BLOCKSIZE;
+
+		for (unsigned int i = 1; valid && i <= padding; i++)
+			valid = decrypted[length - i] == padding;
+
+		if (!valid) {
+			CryptoPP::SecureWipeArray(decrypted, length);
+			error = "Invalid PKCS #7 block padding found";
+			return false;
+		}
+
+		decrypted_length = length - padding;
+		return true;
+	}
 };
 
 aes::aes(const std::string& key, const std::string& iv) : _d(*new impl(key, iv)) {}
 aes::~aes() { delete& _d; }
 
-bool aes::encrypt(const std::string& input,
+size_t aes::encrypted_size(size_t length) {
+	// PKCS #7 padding, as used by Crypto++'s StreamTransformationFilter
+	return (length / CryptoPP::AES::BLOCKSIZE + 1) * CryptoPP::AES::BLOCKSIZE;
+}
+
+bool aes::encrypt(std::string_view input,
 	std::string& encrypted, std::string& error) {
 	error.clear();
 	encrypted.clear();
 	try {
-		CryptoPP::AES::Encryption aesEncryption(_d._key, CryptoPP::AES::MAX_KEYLENGTH);
-		CryptoPP::CBC_Mode_ExternalCipher::Encryption cbcEncryption(aesEncryption, _d._iv);
+		size_t encrypted_length = 0;
+		encrypted.resize(encrypted_size(input.size()));
+
+		if (!encrypt(input.data(), input.size(),
+			reinterpret_cast<unsigned char*>(&encrypted[0]), encrypted_length, error)) {
+			encrypted.clear();
+			return false;
+		}
 
-		CryptoPP::StreamTransformationFilter stfEncryptor(cbcEncryption, new CryptoPP::StringSink(encrypted));
-		stfEncryptor.Put(reinterpret_cast<const unsigned char*>(input.c_str()), input.length());
-		stfEncryptor.MessageEnd();
+		encrypted.resize(encrypted_length);
 		return true;
 	}
-	catch (CryptoPP::Exception& e) {
+	catch (const std::exception& e) {
 		error = e.what();
 		return false;
 	}
+}
+
+bool aes::decrypt(std::string_view input,
+	std::string& decrypted, std::string& error) {
+	error.clear();
+	decrypted.clear();
+	try {
+		size_t decrypted_length = 0;
+		decrypted.resize(input.size());
+
+		if (!decrypt(input.data(), input.size(),
+			reinterpret_cast<unsigned char*>(&decrypted[0]), decrypted_length, error)) {
+			decrypted.clear();
+			return false;
+		}
+
+		decrypted.resize(decrypted_length);
+		return true;
+	}
 	catch (const std::exception& e) {
 		error = e.what();
 		return false;
 	}
 }
 
+bool aes::encrypt(const std::string& input,
+	std::string& encrypted, std::string& error) {
+	return encrypt(std::string_view(input), encrypted, error);
+}
+
 bool aes::decrypt(const std::string& input,
 	std::string& decrypted, std::string& error) {
+	return decrypt(std::string_view(input), decrypted, error);
+}
+
+bool aes::encrypt(const void* data, size_t length,
+	unsigned char* encrypted, size_t& encrypted_length, std::string& error) {
+	error.clear();
+	encrypted_length = 0;
+	try {
+		CryptoPP::AES::Encryption aesEncryption;
+		_d.expand(aesEncryption);
+		_d.encrypt(aesEncryption, _d._iv, data, length, encrypted, encrypted_length);
+		return true;
+	}
+	catch (CryptoPP::Exception& e) {
+		error = e.what();
+		return false;
+	}
+	catch (const std::exception& e) {
+		error = e.what();
+		return false;
+	}
+}
+
+bool aes::decrypt(const void* data, size_t length,
+	unsigned char* decrypted, size_t& decrypted_length, std::string& error) {
+	error.clear();
+	decrypted_length = 0;
+	try {
+		CryptoPP::AES::Decryption aesDecryption;
+		_d.expand(aesDecryption);
+		return _d.decrypt(aesDecryption, _d._iv, data, length, decrypted, decrypted_length, error);
+	}
+	catch (CryptoPP::Exception& e) {
+		error = e.what();
+		return false;
+	}
+	catch (const std::exception& e) {
+		error = e.what();
+		return false;
+	}
+}
+
+bool aes::encrypt_in_place(unsigned char* buffer, size_t buffer_size,
+	size_t payload_length, size_t& encrypted_length, std::string& error) {
+	error.clear();
+	encrypted_length = 0;
+
+	if (buffer_size < encrypted_size(payload_length)) {
+		error = "Buffer too small";
+		return false;
+	}
+
+	// the whole blocks are encrypted where they are, and the padding goes into the room after them
+	return encrypt(buffer, payload_length, buffer, encrypted_length, error);
+}
+
+bool aes::decrypt_in_place(unsigned char* buffer, size_t length,
+	size_t& decrypted_length, std::string& error) {
+	return decrypt(buffer, length, buffer, decrypted_length, error);
+}
+
+bool aes::encrypt_batch(const std::vector<std::string_view>& records,
+	const unsigned char* ivs, std::string& encrypted,
+	std::vector<size_t>& offsets, std::string& error) {
+	error.clear();
+	encrypted.clear();
+	offsets.clear();
+	try {
+		offsets.resize(records.size() + 1);
+		offsets[0] = 0;
+
+		for (size_t i = 0; i < records.size(); i++)
+			offsets[i + 1] = offsets[i] + encrypted_size(records[i].size());
+
+		encrypted.resize(offsets.back());
+		unsigned char* p_encrypted = reinterpret_cast<unsigned char*>(&encrypted[0]);
+
+		CryptoPP::AES::Encryption aesEncryption;
+		_d.expand(aesEncryption);
+
+		for (size_t i = 0; i < records.size(); i++) {
+			size_t encrypted_length = 0;
+			_d.encrypt(aesEncryption, ivs + i * CryptoPP::AES::BLOCKSIZE, records[i].data(), records[i].size(),
+				p_encrypted + offsets[i], encrypted_length);
+		}
+
+		return true;
+	}
+	catch (CryptoPP::Exception& e) {
+		encrypted.clear();
+		offsets.clear();
+		error = e.what();
+		return false;
+	}
+	catch (const std::exception& e) {
+		encrypted.clear();
+		offsets.clear();
+		error = e.what();
+		return false;
+	}
+}
+
+bool aes::decrypt_batch(std::string_view encrypted,
+	const std::vector<size_t>& offsets, const unsigned char* ivs,
+	std::string& decrypted, std::vector<size_t>& decrypted_offsets, std::string& error) {
 	error.clear();
 	decrypted.clear();
+	decrypted_offsets.clear();
 	try {
-		CryptoPP::AES::Decryption aesDecryption(_d._key, CryptoPP::AES::MAX_KEYLENGTH);
-		CryptoPP::CBC_Mode_ExternalCipher::Decryption cbcDecryption(aesDecryption, _d._iv);
+		if (offsets.empty() || offsets.back() > encrypted.size()) {
+			error = "Invalid offsets";
+			return false;
+		}
+
+		for (size_t i = 1; i < offsets.size(); i++) {
+			if (offsets[i] < offsets[i - 1]) {
+				error = "Invalid offsets";
+				return false;
+			}
+		}
+
+		const size_t count = offsets.size() - 1;
+
+		// the padding is only known after decryption, so allow for the whole input
+		decrypted.resize(offsets.back() - offsets.front());
+		decrypted_offsets.resize(count + 1);
+		decrypted_offsets[0] = 0;
+
+		unsigned char* p_decrypted = reinterpret_cast<unsigned char*>(&decrypted[0]);
+
+		CryptoPP::AES::Decryption aesDecryption;
+		_d.expand(aesDecryption);
+
+		for (size_t i = 0; i < count; i++) {
+			size_t decrypted_length = 0;
+			if (!_d.decrypt(aesDecryption, ivs + i * CryptoPP::AES::BLOCKSIZE, encrypted.data() + offsets[i],
+				offsets[i + 1] - offsets[i], p_decrypted + decrypted_offsets[i], decrypted_length, error)) {
+				error = "Record " + std::to_string(i) + ": " + error;
+				decrypted.clear();
+				decrypted_offsets.clear();
+				return false;
+			}
+
+			decrypted_offsets[i + 1] = decrypted_offsets[i] + decrypted_length;
+		}
 
-		CryptoPP::StreamTransformationFilter stfDecryptor(cbcDecryption, new CryptoPP::StringSink(decrypted));
-		stfDecryptor.Put(reinterpret_cast<const unsigned char*>(input.c_str()), input.size());
-		stfDecryptor.MessageEnd();
+		decrypted.resize(decrypted_offsets.back());
 		return true;
 	}
 	catch (CryptoPP::Exception& e) {
+		decrypted.clear();
+		decrypted_offsets.clear();
 		error = e.what();
 		return false;
 	}
 	catch (const std::exception& e) {
+		decrypted.clear();
+		decrypted_offsets.clear();
 		error = e.what();
 		return false;
 	}
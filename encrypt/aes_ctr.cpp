@@ -0,0 +1,112 @@
+//
+// aes_ctr.cpp - parallel AES-CTR encryption implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../encrypt.h"
+#include "../executor/parallel_for.h"
+
+#include <aes.h>
+#include <modes.h>
+#include <misc.h>
+#include <cstring>
+#include <algorithm>
+
+using namespace liblec::leccore;
+
+// size of the ranges buffers are split into; a multiple of the block size, and large enough for
+// keying the cipher for each range not to matter
+static const size_t _range_size = 256 * 1024;
+
+class aes_ctr::impl {
+public:
+	CryptoPP::byte _key[key_size];
+	unsigned int _max_threads;
+
+	impl(const std::string& key, unsigned int max_threads) :
+		_max_threads(max_threads) {
+		memset(_key, 0, sizeof(_key));
+		memcpy(_key, key.data(), (std::min)(key.size(), sizeof(_key)));
+	}
+	~impl() {
+		CryptoPP::SecureWipeArray(_key, sizeof(_key));
+	}
+
+	// the counter block of the given block of the data: iv + block, as a 128 bit big-endian number
+	static void counter_at(const unsigned char* iv, unsigned long long block, CryptoPP::byte* counter) {
+		memcpy(counter, iv, iv_size);
+
+		unsigned int carry = 0;
+		for (size_t i = iv_size; i-- > 0;) {
+			const unsigned int sum = counter[i] + static_cast<unsigned int>(block & 0xff) + carry;
+			counter[i] = static_cast<CryptoPP::byte>(sum);
+			carry = sum >> 8;
+			block >>= 8;
+
+			if (block == 0 && carry == 0)
+				break;
+		}
+	}
+
+	// encrypt one range of the data, starting at a block boundary
+	void process_range(const unsigned char* iv, CryptoPP::byte* data, size_t offset, size_t length) {
+		CryptoPP::byte counter[iv_size];
+		counter_at(iv, offset / CryptoPP::AES::BLOCKSIZE, counter);
+
+		// each range has cipher objects of its own, so that nothing is shared between threads
+		CryptoPP::AES::Encryption aesEncryption(_key, sizeof(_key));
+		CryptoPP::CTR_Mode_ExternalCipher::Encryption ctrEncryption(aesEncryption, counter);
+		ctrEncryption.ProcessData(data + offset, data + offset, length);
+	}
+
+	bool process(const unsigned char* iv, void* data, size_t length, std::string& error) {
+		error.clear();
+		try {
+			CryptoPP::byte* bytes = reinterpret_cast<CryptoPP::byte*>(data);
+			const size_t ranges = (length + _range_size - 1) / _range_size;
+
+			if (ranges <= 1) {
+				if (length)
+					process_range(iv, bytes, 0, length);
+
+				return true;
+			}
+
+			auto range = [&](size_t i) {
+				const size_t offset = i * _range_size;
+				process_range(iv, bytes, offset, (std::min)(_range_size, length - offset));
+			};
+
+			parallel_for(ranges, range, _max_threads);
+
+			return true;
+		}
+		catch (CryptoPP::Exception& e) {
+			error = e.what();
+			return false;
+		}
+		catch (const std::exception& e) {
+			error = e.what();
+			return false;
+		}
+	}
+};
+
+aes_ctr::aes_ctr(const std::string& key, unsigned int max_threads) :
+	_d(*new impl(key, max_threads)) {}
+aes_ctr::~aes_ctr() { delete& _d; }
+
+bool aes_ctr::encrypt(const unsigned char* iv,
+	void* data, size_t length, std::string& error) {
+	return _d.process(iv, data, length, error);
+}
+
+bool aes_ctr::decrypt(const unsigned char* iv,
+	void* data, size_t length, std::string& error) {
+	return _d.process(iv, data, length, error);
+}
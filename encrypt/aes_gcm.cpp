@@ -0,0 +1,66 @@
+//
+// aes_gcm.cpp - AES-GCM authenticated encryption implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../encrypt.h"
+#include "aead.h"
+
+#include <aes.h>
+#include <gcm.h>
+
+using namespace liblec::leccore;
+
+// Crypto++ picks AES-NI and PCLMULQDQ at run time when the processor has them. Keying the objects
+// expands the key and builds the GHASH tables, so it is done once, in the constructor.
+class aes_gcm::impl : public aead<CryptoPP::GCM<CryptoPP::AES>::Encryption,
+	CryptoPP::GCM<CryptoPP::AES>::Decryption, key_size, nonce_size, tag_size> {
+public:
+	impl(const std::string& key) : aead(key) {}
+	~impl() {}
+};
+
+aes_gcm::aes_gcm(const std::string& key) : _d(*new impl(key)) {}
+aes_gcm::~aes_gcm() { delete& _d; }
+
+bool aes_gcm::encrypt(const unsigned char* nonce,
+	const void* data, size_t length,
+	std::string_view associated_data,
+	unsigned char* encrypted, unsigned char* tag,
+	std::string& error) {
+	return _d.encrypt(nonce, data, length, associated_data, encrypted, tag, error);
+}
+
+bool aes_gcm::decrypt(const unsigned char* nonce,
+	const void* data, size_t length,
+	std::string_view associated_data,
+	const unsigned char* tag,
+	unsigned char* decrypted,
+	std::string& error) {
+	return _d.decrypt(nonce, data, length, associated_data, tag, decrypted, error);
+}
+
+bool aes_gcm::encrypt(std::string_view input,
+	std::string& encrypted, std::string& error) {
+	return _d.encrypt(input, encrypted, error);
+}
+
+bool aes_gcm::decrypt(std::string_view input,
+	std::string& decrypted, std::string& error) {
+	return _d.decrypt(input, decrypted, error);
+}
+
+bool aes_gcm::encrypt_in_place(unsigned char* buffer, size_t buffer_size,
+	size_t payload_length, size_t& encrypted_length, std::string& error) {
+	return _d.encrypt_in_place(buffer, buffer_size, payload_length, encrypted_length, error);
+}
+
+bool aes_gcm::decrypt_in_place(unsigned char* buffer, size_t length,
+	size_t& decrypted_length, std::string& error) {
+	return _d.decrypt_in_place(buffer, length, decrypted_length, error);
+}
@@ -0,0 +1,64 @@
+//
+// chacha20_poly1305.cpp - ChaCha20-Poly1305 authenticated encryption implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../encrypt.h"
+#include "aead.h"
+
+#include <chachapoly.h>
+
+using namespace liblec::leccore;
+
+// Crypto++ runs ChaCha20 on AVX2 or SSE2 and Poly1305 on 64 bit multiplies, picked at run time.
+class chacha20_poly1305::impl : public aead<CryptoPP::ChaCha20Poly1305::Encryption,
+	CryptoPP::ChaCha20Poly1305::Decryption, key_size, nonce_size, tag_size> {
+public:
+	impl(const std::string& key) : aead(key) {}
+	~impl() {}
+};
+
+chacha20_poly1305::chacha20_poly1305(const std::string& key) : _d(*new impl(key)) {}
+chacha20_poly1305::~chacha20_poly1305() { delete& _d; }
+
+bool chacha20_poly1305::encrypt(const unsigned char* nonce,
+	const void* data, size_t length,
+	std::string_view associated_data,
+	unsigned char* encrypted, unsigned char* tag,
+	std::string& error) {
+	return _d.encrypt(nonce, data, length, associated_data, encrypted, tag, error);
+}
+
+bool chacha20_poly1305::decrypt(const unsigned char* nonce,
+	const void* data, size_t length,
+	std::string_view associated_data,
+	const unsigned char* tag,
+	unsigned char* decrypted,
+	std::string& error) {
+	return _d.decrypt(nonce, data, length, associated_data, tag, decrypted, error);
+}
+
+bool chacha20_poly1305::encrypt(std::string_view input,
+	std::string& encrypted, std::string& error) {
+	return _d.encrypt(input, encrypted, error);
+}
+
+bool chacha20_poly1305::decrypt(std::string_view input,
+	std::string& decrypted, std::string& error) {
+	return _d.decrypt(input, decrypted, error);
+}
+
+bool chacha20_poly1305::encrypt_in_place(unsigned char* buffer, size_t buffer_size,
+	size_t payload_length, size_t& encrypted_length, std::string& error) {
+	return _d.encrypt_in_place(buffer, buffer_size, payload_length, encrypted_length, error);
+}
+
+bool chacha20_poly1305::decrypt_in_place(unsigned char* buffer, size_t length,
+	size_t& decrypted_length, std::string& error) {
+	return _d.decrypt_in_place(buffer, length, decrypted_length, error);
+}
@@ -0,0 +1,193 @@
+//
+// chunk_cipher.cpp - chunked authenticated encryption implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "chunk_cipher.h"
+#include "../hash.h"
+
+#include <cstring>
+
+using namespace liblec::leccore;
+
+namespace {
+	const unsigned char _magic[4] = { 'l', 'e', 'c', 0x01 };
+
+	// the chunk index is 4 bytes of the nonce
+	const unsigned long long _max_chunks = 0x100000000ULL;
+
+	const size_t _prefix_offset = 9;
+	const size_t _prefix_size = encrypt_stream::header_size - _prefix_offset;
+}
+
+chunk_cipher::chunk_cipher() :
+	_chunk_size(0),
+	_index(0),
+	_finished(false) {
+	memset(_header, 0, sizeof(_header));
+}
+
+chunk_cipher::~chunk_cipher() {}
+
+bool chunk_cipher::start_encryption(const std::string& key,
+	cipher algorithm,
+	size_t chunk_size,
+	std::string& error) {
+	error.clear();
+
+	if (chunk_size < encrypt_stream::min_chunk_size || chunk_size > encrypt_stream::max_chunk_size) {
+		error = "Invalid chunk size";
+		return false;
+	}
+
+	memcpy(_header, _magic, sizeof(_magic));
+	_header[4] = static_cast<unsigned char>(algorithm);
+
+	for (int i = 0; i < 4; i++)
+		_header[5 + i] = static_cast<unsigned char>(chunk_size >> (8 * i));
+
+	if (!hash_string::random_bytes(_header + _prefix_offset, _prefix_size)) {
+		error = "Generating the nonce failed";
+		return false;
+	}
+
+	return start_decryption(key, _header, error);
+}
+
+bool chunk_cipher::start_decryption(const std::string& key,
+	const unsigned char* header,
+	std::string& error) {
+	error.clear();
+
+	if (memcmp(header, _magic, sizeof(_magic)) != 0) {
+		error = "Unrecognized data format";
+		return false;
+	}
+
+	size_t chunk_size = 0;
+	for (int i = 0; i < 4; i++)
+		chunk_size |= static_cast<size_t>(header[5 + i]) << (8 * i);
+
+	// the chunk size decides how much memory decryption takes, so it is checked before use
+	if (chunk_size < encrypt_stream::min_chunk_size || chunk_size > encrypt_stream::max_chunk_size) {
+		error = "Invalid chunk size";
+		return false;
+	}
+
+	_p_aes_gcm.reset();
+	_p_chacha20_poly1305.reset();
+
+	switch (static_cast<cipher>(header[4])) {
+	case cipher::aes_gcm:
+		_p_aes_gcm = std::make_unique<aes_gcm>(key);
+		break;
+
+	case cipher::chacha20_poly1305:
+		_p_chacha20_poly1305 = std::make_unique<chacha20_poly1305>(key);
+		break;
+
+	default:
+		error = "Unsupported cipher";
+		return false;
+	}
+
+	if (header != _header)
+		memcpy(_header, header, sizeof(_header));
+
+	_chunk_size = chunk_size;
+	_index = 0;
+	_finished = false;
+	return true;
+}
+
+bool chunk_cipher::next_nonce(bool last, unsigned char* nonce, std::string& error) {
+	if (!_p_aes_gcm && !_p_chacha20_poly1305) {
+		error = "Cipher not initialized";
+		return false;
+	}
+
+	if (_finished) {
+		error = "Data after the last chunk";
+		return false;
+	}
+
+	if (_index == _max_chunks) {
+		error = "Data too large";
+		return false;
+	}
+
+	memcpy(nonce, _header + _prefix_offset, _prefix_size);
+
+	for (int i = 0; i < 4; i++)
+		nonce[_prefix_size + i] = static_cast<unsigned char>(_index >> (8 * (3 - i)));
+
+	nonce[_prefix_size + 4] = last ? 1 : 0;
+
+	_index++;
+	_finished = last;
+	return true;
+}
+
+bool chunk_cipher::seal(const unsigned char* data,
+	size_t length,
+	bool last,
+	unsigned char* sealed,
+	std::string& error) {
+	error.clear();
+
+	if (length > _chunk_size || (!last && length != _chunk_size)) {
+		error = "Invalid chunk length";
+		return false;
+	}
+
+	unsigned char nonce[aes_gcm::nonce_size];
+	if (!next_nonce(last, nonce, error))
+		return false;
+
+	const std::string_view associated_data(reinterpret_cast<const char*>(_header), sizeof(_header));
+
+	if (_p_aes_gcm)
+		return _p_aes_gcm->encrypt(nonce, data, length, associated_data,
+			sealed, sealed + length, error);
+
+	return _p_chacha20_poly1305->encrypt(nonce, data, length, associated_data,
+		sealed, sealed + length, error);
+}
+
+bool chunk_cipher::open(const unsigned char* sealed,
+	size_t length,
+	bool last,
+	unsigned char* data,
+	std::string& error) {
+	error.clear();
+
+	if (length < encrypt_stream::tag_size) {
+		error = "Invalid ciphertext length";
+		return false;
+	}
+
+	const size_t data_length = length - encrypt_stream::tag_size;
+
+	if (data_length > _chunk_size || (!last && data_length != _chunk_size)) {
+		error = "Invalid ciphertext length";
+		return false;
+	}
+
+	unsigned char nonce[aes_gcm::nonce_size];
+	if (!next_nonce(last, nonce, error))
+		return false;
+
+	const std::string_view associated_data(reinterpret_cast<const char*>(_header), sizeof(_header));
+
+	if (_p_aes_gcm)
+		return _p_aes_gcm->decrypt(nonce, sealed, data_length, associated_data,
+			sealed + data_length, data, error);
+
+	return _p_chacha20_poly1305->decrypt(nonce, sealed, data_length, associated_data,
+		sealed + data_length, data, error);
+}
@@ -0,0 +1,72 @@
+//
+// chunk_cipher.h - chunked authenticated encryption interface
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include "../encrypt.h"
+#include <memory>
+
+namespace liblec {
+	namespace leccore {
+		// Encrypts and decrypts the chunks of the format shared by encrypt_stream and encrypt_file.
+		// The data starts with a 16 byte header:
+		//
+		//   "lec" 0x01 (4) | cipher (1) | chunk size, little-endian (4) | random nonce prefix (7)
+		//
+		// followed by the chunks, each encrypted with the header as associated data and followed by
+		// its tag. Every chunk but the last holds exactly chunk size bytes, and the last holds the
+		// rest, which may be nothing. A chunk's nonce is the prefix, the chunk's index (4 bytes,
+		// big-endian) and a byte that is 1 for the last chunk and 0 otherwise.
+		class chunk_cipher {
+			std::unique_ptr<aes_gcm> _p_aes_gcm;
+			std::unique_ptr<chacha20_poly1305> _p_chacha20_poly1305;
+			unsigned char _header[encrypt_stream::header_size];
+			size_t _chunk_size;
+			unsigned long long _index;
+			bool _finished;
+
+			// the nonce of the next chunk
+			bool next_nonce(bool last, unsigned char* nonce, std::string& error);
+
+		public:
+			chunk_cipher();
+			~chunk_cipher();
+
+			// key the cipher for encryption and make a new header
+			bool start_encryption(const std::string& key,
+				cipher algorithm,
+				size_t chunk_size,
+				std::string& error);
+
+			// key the cipher for decryption with the cipher and chunk size in the header
+			bool start_decryption(const std::string& key,
+				const unsigned char* header,
+				std::string& error);
+
+			const unsigned char* header() const { return _header; }
+			size_t chunk_size() const { return _chunk_size; }
+
+			// encrypt the next chunk, of up to chunk_size() bytes, into length + tag_size bytes
+			bool seal(const unsigned char* data,
+				size_t length,
+				bool last,
+				unsigned char* sealed,
+				std::string& error);
+
+			// verify and decrypt the next chunk, of up to chunk_size() + tag_size bytes including the
+			// tag, into length - tag_size bytes
+			bool open(const unsigned char* sealed,
+				size_t length,
+				bool last,
+				unsigned char* data,
+				std::string& error);
+		};
+	}
+}
@@ -0,0 +1,499 @@
+//
+// encrypt_file.cpp - file encryption/decryption implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../encrypt.h"
+#include "chunk_cipher.h"
+#include "../executor/async_task.h"
+
+#include <cryptlib.h>
+#include <misc.h>
+#include <atomic>
+#include <vector>
+#include <Windows.h>
+
+using namespace liblec::leccore;
+
+namespace {
+	// closes a Win32 handle when going out of scope
+	class handle_guard {
+		HANDLE _handle;
+
+	public:
+		handle_guard(HANDLE handle) :
+			_handle(handle) {}
+		~handle_guard() {
+			if (_handle && _handle != INVALID_HANDLE_VALUE)
+				CloseHandle(_handle);
+		}
+
+		HANDLE get() const { return _handle; }
+		bool valid() const { return _handle && _handle != INVALID_HANDLE_VALUE; }
+	};
+
+	// a buffer that the system reads into or writes from
+	struct transfer {
+		OVERLAPPED overlapped;
+		std::vector<unsigned char> data;
+		DWORD length;
+		bool pending;
+	};
+
+	bool issue(HANDLE file, bool write, transfer& t, unsigned long long offset, DWORD length) {
+		t.length = length;
+		if (length == 0)
+			return true;
+
+		HANDLE event = t.overlapped.hEvent;
+		t.overlapped = {};
+		t.overlapped.Offset = static_cast<DWORD>(offset);
+		t.overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+		t.overlapped.hEvent = event;
+
+		const BOOL done = write ?
+			WriteFile(file, t.data.data(), length, nullptr, &t.overlapped) :
+			ReadFile(file, t.data.data(), length, nullptr, &t.overlapped);
+
+		if (!done && GetLastError() != ERROR_IO_PENDING)
+			return false;
+
+		t.pending = true;
+		return true;
+	}
+
+	// wait for a transfer; only true if all of it went through
+	bool complete(HANDLE file, transfer& t) {
+		if (!t.pending)
+			return true;
+
+		t.pending = false;
+		DWORD transferred = 0;
+		return GetOverlappedResult(file, &t.overlapped, &transferred, TRUE) && transferred == t.length;
+	}
+
+	// the buffers must not be released while the system may still be using them
+	void abandon(HANDLE file, transfer* transfers, size_t count) {
+		for (size_t i = 0; i < count; i++) {
+			if (transfers[i].pending) {
+				DWORD transferred = 0;
+				CancelIoEx(file, &transfers[i].overlapped);
+				GetOverlappedResult(file, &transfers[i].overlapped, &transferred, TRUE);
+				transfers[i].pending = false;
+			}
+		}
+	}
+
+	struct crypt_result {
+		bool success = false;
+		std::string error;
+	};
+
+	// Shared by encrypt_file and decrypt_file. The source is streamed through the cipher a chunk
+	// at a time, with two buffers for reading and two for writing, so that while one chunk is
+	// being processed the system is reading the next and writing the previous one.
+	class file_job {
+		bool pump(chunk_cipher& cipher, HANDLE source, HANDLE destination,
+			unsigned long long size, std::string& error) {
+			handle_guard events[4] = {
+				CreateEventA(nullptr, TRUE, FALSE, nullptr), CreateEventA(nullptr, TRUE, FALSE, nullptr),
+				CreateEventA(nullptr, TRUE, FALSE, nullptr), CreateEventA(nullptr, TRUE, FALSE, nullptr)
+			};
+
+			for (const auto& event : events) {
+				if (!event.valid()) {
+					error = "Error creating event";
+					return false;
+				}
+			}
+
+			transfer reads[2] = {};
+			transfer writes[2] = {};
+
+			for (int i = 0; i < 2; i++) {
+				reads[i].overlapped.hEvent = events[i].get();
+				writes[i].overlapped.hEvent = events[2 + i].get();
+			}
+
+			const size_t header_size = encrypt_stream::header_size;
+			unsigned long long read_offset = 0;
+			unsigned long long write_offset = 0;
+
+			if (_encrypting) {
+				if (!cipher.start_encryption(_key, _algorithm, encrypt_stream::default_chunk_size, error))
+					return false;
+
+				writes[0].data.assign(cipher.header(), cipher.header() + header_size);
+
+				if (!issue(destination, true, writes[0], write_offset, static_cast<DWORD>(header_size)) ||
+					!complete(destination, writes[0])) {
+					abandon(destination, writes, 2);
+					error = "Error writing file";
+					return false;
+				}
+
+				write_offset += header_size;
+			}
+			else {
+				if (size < header_size + encrypt_stream::tag_size) {
+					error = "Invalid ciphertext length";
+					return false;
+				}
+
+				reads[0].data.resize(header_size);
+
+				if (!issue(source, false, reads[0], read_offset, static_cast<DWORD>(header_size)) ||
+					!complete(source, reads[0])) {
+					abandon(source, reads, 2);
+					error = "Error reading file";
+					return false;
+				}
+
+				if (!cipher.start_decryption(_key, reads[0].data.data(), error))
+					return false;
+
+				read_offset += header_size;
+				_processed += header_size;
+			}
+
+			const size_t chunk_size = cipher.chunk_size();
+			const size_t tag_size = encrypt_stream::tag_size;
+			const size_t read_size = _encrypting ? chunk_size : chunk_size + tag_size;
+			const size_t write_size = _encrypting ? chunk_size + tag_size : chunk_size;
+
+			// every chunk but the last is whole, and there is always a last chunk, even if empty
+			const unsigned long long body = size - read_offset;
+			const unsigned long long chunks = body == 0 ? 1 : (body + read_size - 1) / read_size;
+			const size_t last_size = static_cast<size_t>(body - (chunks - 1) * read_size);
+
+			if (!_encrypting && last_size < tag_size) {
+				error = "Invalid ciphertext length";
+				return false;
+			}
+
+			for (int i = 0; i < 2; i++) {
+				reads[i].data.resize(read_size);
+				writes[i].data.resize(write_size);
+			}
+
+			auto abandon_all = [&]() {
+				abandon(source, reads, 2);
+				abandon(destination, writes, 2);
+			};
+
+			auto read_length = [&](unsigned long long chunk) {
+				return static_cast<DWORD>(chunk + 1 < chunks ? read_size : last_size);
+			};
+
+			if (!issue(source, false, reads[0], read_offset, read_length(0))) {
+				error = "Error reading file";
+				return false;
+			}
+
+			read_offset += read_length(0);
+
+			for (unsigned long long chunk = 0; chunk < chunks; chunk++) {
+				transfer& in = reads[chunk % 2];
+				transfer& out = writes[chunk % 2];
+				const bool last = chunk + 1 == chunks;
+
+				if (!complete(source, in)) {
+					abandon_all();
+					error = "Error reading file";
+					return false;
+				}
+
+				// start reading the next chunk before processing this one
+				if (!last) {
+					if (!issue(source, false, reads[(chunk + 1) % 2], read_offset, read_length(chunk + 1))) {
+						abandon_all();
+						error = "Error reading file";
+						return false;
+					}
+
+					read_offset += read_length(chunk + 1);
+				}
+
+				if (_task.cancelled()) {
+					abandon_all();
+					error = "Operation cancelled";
+					return false;
+				}
+
+				// the buffer is free once the write from two chunks ago is through
+				if (!complete(destination, out)) {
+					abandon_all();
+					error = "Error writing file";
+					return false;
+				}
+
+				const bool processed = _encrypting ?
+					cipher.seal(in.data.data(), in.length, last, out.data.data(), error) :
+					cipher.open(in.data.data(), in.length, last, out.data.data(), error);
+
+				if (!processed) {
+					abandon_all();
+					return false;
+				}
+
+				const DWORD length = _encrypting ?
+					in.length + static_cast<DWORD>(tag_size) : in.length - static_cast<DWORD>(tag_size);
+
+				if (!issue(destination, true, out, write_offset, length)) {
+					abandon_all();
+					error = "Error writing file";
+					return false;
+				}
+
+				write_offset += length;
+				_processed += in.length;
+			}
+
+			for (auto& out : writes) {
+				if (!complete(destination, out)) {
+					abandon_all();
+					error = "Error writing file";
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+	public:
+		std::string _key;
+		cipher _algorithm;
+		bool _encrypting;
+		std::string _source;
+		std::string _destination;
+		std::atomic<unsigned long long> _total{ 0 };
+		std::atomic<unsigned long long> _processed{ 0 };
+		async_task<crypt_result> _task;
+
+		file_job(const std::string& key, cipher algorithm, bool encrypting) :
+			_key(key),
+			_algorithm(algorithm),
+			_encrypting(encrypting) {}
+		~file_job() {
+			if (!_key.empty())
+				CryptoPP::SecureWipeArray(&_key[0], _key.size());
+		}
+
+		static crypt_result crypt_func(file_job* p_job) {
+			file_job& _d = *p_job;
+
+			crypt_result result;
+
+			if (_d._source.empty() || _d._destination.empty()) {
+				result.error = "File path not specified";
+				return result;
+			}
+
+			try {
+				// shared like the file streams share it, so a file another process has open, even
+				// for writing, can still be encrypted
+				handle_guard source(CreateFileA(_d._source.c_str(), GENERIC_READ,
+					FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+					FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+
+				if (!source.valid()) {
+					result.error = "Error opening file";
+					return result;
+				}
+
+				LARGE_INTEGER size;
+				if (!GetFileSizeEx(source.get(), &size)) {
+					result.error = "Error reading file";
+					return result;
+				}
+
+				_d._total = static_cast<unsigned long long>(size.QuadPart);
+
+				{
+					handle_guard destination(CreateFileA(_d._destination.c_str(), GENERIC_WRITE, 0,
+						nullptr, CREATE_ALWAYS, FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+
+					if (!destination.valid()) {
+						result.error = "Error creating file";
+						return result;
+					}
+
+					chunk_cipher cipher;
+					result.success = _d.pump(cipher, source.get(), destination.get(),
+						static_cast<unsigned long long>(size.QuadPart), result.error);
+				}
+
+				// leave nothing partial or unauthenticated behind
+				if (!result.success)
+					DeleteFileA(_d._destination.c_str());
+
+				return result;
+			}
+			catch (const CryptoPP::Exception& e) {
+				DeleteFileA(_d._destination.c_str());
+				result.error = e.what();
+				result.success = false;
+				return result;
+			}
+			catch (const std::exception& e) {
+				DeleteFileA(_d._destination.c_str());
+				result.error = e.what();
+				result.success = false;
+				return result;
+			}
+		}
+
+		void start(const std::string& source, const std::string& destination) {
+			_source = source;
+			_destination = destination;
+			_total = 0;
+			_processed = 0;
+
+			// run task asynchronously
+			_task.start(crypt_func, this);
+		}
+
+		bool result(std::string& error) {
+			error.clear();
+
+			if (_task.running()) {
+				error = "Task not yet complete";
+				return false;
+			}
+
+			if (_task.valid()) {
+				auto result = _task.get();
+				error = result.error;
+				return result.success;
+			}
+
+			error = "unexpected error";
+			return false;
+		}
+	};
+}
+
+class encrypt_file::impl : public file_job {
+public:
+	impl(const std::string& key, cipher algorithm) :
+		file_job(key, algorithm, true) {}
+	~impl() {}
+};
+
+encrypt_file::encrypt_file(const std::string& key, cipher algorithm) :
+	_d(*new impl(key, algorithm)) {}
+encrypt_file::~encrypt_file() {
+	_d._task.cancel();
+	_d._task.join();
+
+	delete& _d;
+}
+
+void encrypt_file::start(const std::string& source,
+	const std::string& destination) {
+	if (encrypting()) {
+		// allow only one instance
+		return;
+	}
+
+	_d.start(source, destination);
+}
+
+bool encrypt_file::encrypting() {
+	return _d._task.running();
+}
+
+bool encrypt_file::encrypting(progress_info& progress) {
+	progress.total = _d._total;
+	progress.processed = _d._processed;
+	return _d._task.running();
+}
+
+bool encrypt_file::result(std::string& error) {
+	return _d.result(error);
+}
+
+void encrypt_file::on_complete(std::function<void()> callback) {
+	_d._task.on_complete(callback);
+}
+
+bool encrypt_file::wait(unsigned long long timeout_milliseconds) {
+	return _d._task.wait(timeout_milliseconds);
+}
+
+void* encrypt_file::completion_event() {
+	return _d._task.completion_event();
+}
+
+void encrypt_file::cancel() {
+	_d._task.cancel();
+}
+
+void encrypt_file::set_cancellation_token(const cancellation_token& token) {
+	_d._task.link(token);
+}
+
+class decrypt_file::impl : public file_job {
+public:
+	impl(const std::string& key) :
+		file_job(key, cipher::aes_gcm, false) {}
+	~impl() {}
+};
+
+decrypt_file::decrypt_file(const std::string& key) :
+	_d(*new impl(key)) {}
+decrypt_file::~decrypt_file() {
+	_d._task.cancel();
+	_d._task.join();
+
+	delete& _d;
+}
+
+void decrypt_file::start(const std::string& source,
+	const std::string& destination) {
+	if (decrypting()) {
+		// allow only one instance
+		return;
+	}
+
+	_d.start(source, destination);
+}
+
+bool decrypt_file::decrypting() {
+	return _d._task.running();
+}
+
+bool decrypt_file::decrypting(encrypt_file::progress_info& progress) {
+	progress.total = _d._total;
+	progress.processed = _d._processed;
+	return _d._task.running();
+}
+
+bool decrypt_file::result(std::string& error) {
+	return _d.result(error);
+}
+
+void decrypt_file::on_complete(std::function<void()> callback) {
+	_d._task.on_complete(callback);
+}
+
+bool decrypt_file::wait(unsigned long long timeout_milliseconds) {
+	return _d._task.wait(timeout_milliseconds);
+}
+
+void* decrypt_file::completion_event() {
+	return _d._task.completion_event();
+}
+
+void decrypt_file::cancel() {
+	_d._task.cancel();
+}
+
+void decrypt_file::set_cancellation_token(const cancellation_token& token) {
+	_d._task.link(token);
+}
@@ -0,0 +1,254 @@
+//
+// encrypt_stream.cpp - chunked encryption/decryption stream implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../encrypt.h"
+#include "chunk_cipher.h"
+
+#include <cryptlib.h>
+#include <misc.h>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+using namespace liblec::leccore;
+
+class encrypt_stream::impl {
+public:
+	chunk_cipher _cipher;
+	sink _output;
+
+	// once set, every further call fails with this error
+	std::string _error;
+
+	bool _header_sent = false;
+
+	// the chunk being filled; a full chunk is held back until it is known whether it is the last
+	std::vector<unsigned char> _buffer;
+	size_t _filled = 0;
+
+	std::vector<unsigned char> _sealed;
+
+	impl(const std::string& key, sink output, cipher algorithm, size_t chunk_size) :
+		_output(output) {
+		if (!_cipher.start_encryption(key, algorithm, chunk_size, _error))
+			return;
+
+		_buffer.resize(chunk_size);
+		_sealed.resize(chunk_size + tag_size);
+	}
+	~impl() {}
+
+	bool emit(const unsigned char* data, size_t length, bool last, std::string& error) {
+		if (!_cipher.seal(data, length, last, _sealed.data(), error)) {
+			_error = error;
+			return false;
+		}
+
+		if (!_header_sent) {
+			_output(reinterpret_cast<const char*>(_cipher.header()), header_size);
+			_header_sent = true;
+		}
+
+		_output(reinterpret_cast<const char*>(_sealed.data()), length + tag_size);
+		return true;
+	}
+};
+
+encrypt_stream::encrypt_stream(const std::string& key, sink output,
+	cipher algorithm, size_t chunk_size) :
+	_d(*new impl(key, output, algorithm, chunk_size)) {}
+encrypt_stream::~encrypt_stream() { delete& _d; }
+
+bool encrypt_stream::update(const void* data, size_t length, std::string& error) {
+	error.clear();
+	if (!_d._error.empty()) {
+		error = _d._error;
+		return false;
+	}
+
+	const unsigned char* input = reinterpret_cast<const unsigned char*>(data);
+	const size_t chunk_size = _d._cipher.chunk_size();
+
+	while (length > 0) {
+		if (_d._filled == chunk_size) {
+			// there is more data, so the held back chunk is not the last
+			if (!_d.emit(_d._buffer.data(), chunk_size, false, error))
+				return false;
+
+			_d._filled = 0;
+		}
+
+		if (_d._filled == 0 && length > chunk_size) {
+			// whole chunks with more data behind them are encrypted without copying
+			if (!_d.emit(input, chunk_size, false, error))
+				return false;
+
+			input += chunk_size;
+			length -= chunk_size;
+			continue;
+		}
+
+		const size_t copy = (std::min)(length, chunk_size - _d._filled);
+		memcpy(_d._buffer.data() + _d._filled, input, copy);
+		_d._filled += copy;
+		input += copy;
+		length -= copy;
+	}
+
+	return true;
+}
+
+bool encrypt_stream::finalize(std::string& error) {
+	error.clear();
+	if (!_d._error.empty()) {
+		error = _d._error;
+		return false;
+	}
+
+	if (!_d.emit(_d._buffer.data(), _d._filled, true, error))
+		return false;
+
+	_d._filled = 0;
+	_d._error = "Stream already finalized";
+	return true;
+}
+
+unsigned long long encrypt_stream::encrypted_size(unsigned long long length,
+	size_t chunk_size) {
+	if (chunk_size < min_chunk_size || chunk_size > max_chunk_size)
+		return 0;
+
+	// there is always a last chunk, even if it is empty
+	const unsigned long long chunks = length == 0 ? 1 : (length + chunk_size - 1) / chunk_size;
+	return header_size + length + chunks * tag_size;
+}
+
+class decrypt_stream::impl {
+public:
+	chunk_cipher _cipher;
+	std::string _key;
+	sink _output;
+
+	// once set, every further call fails with this error
+	std::string _error;
+
+	unsigned char _header[encrypt_stream::header_size];
+	size_t _header_filled = 0;
+
+	// the chunk being filled, with its tag; a full chunk is held back until it is known whether
+	// it is the last
+	std::vector<unsigned char> _buffer;
+	size_t _filled = 0;
+
+	std::vector<unsigned char> _opened;
+
+	impl(const std::string& key, sink output) :
+		_key(key),
+		_output(output) {}
+	~impl() {
+		if (!_key.empty())
+			CryptoPP::SecureWipeArray(&_key[0], _key.size());
+	}
+
+	bool emit(const unsigned char* data, size_t length, bool last, std::string& error) {
+		if (!_cipher.open(data, length, last, _opened.data(), error)) {
+			_error = error;
+			return false;
+		}
+
+		if (length > encrypt_stream::tag_size)
+			_output(reinterpret_cast<const char*>(_opened.data()), length - encrypt_stream::tag_size);
+
+		return true;
+	}
+};
+
+decrypt_stream::decrypt_stream(const std::string& key, sink output) :
+	_d(*new impl(key, output)) {}
+decrypt_stream::~decrypt_stream() { delete& _d; }
+
+bool decrypt_stream::update(const void* data, size_t length, std::string& error) {
+	error.clear();
+	if (!_d._error.empty()) {
+		error = _d._error;
+		return false;
+	}
+
+	const unsigned char* input = reinterpret_cast<const unsigned char*>(data);
+
+	if (_d._header_filled < sizeof(_d._header)) {
+		const size_t copy = (std::min)(length, sizeof(_d._header) - _d._header_filled);
+		memcpy(_d._header + _d._header_filled, input, copy);
+		_d._header_filled += copy;
+		input += copy;
+		length -= copy;
+
+		if (_d._header_filled < sizeof(_d._header))
+			return true;
+
+		if (!_d._cipher.start_decryption(_d._key, _d._header, error)) {
+			_d._error = error;
+			return false;
+		}
+
+		_d._buffer.resize(_d._cipher.chunk_size() + encrypt_stream::tag_size);
+		_d._opened.resize(_d._cipher.chunk_size());
+	}
+
+	const size_t record_size = _d._buffer.size();
+
+	while (length > 0) {
+		if (_d._filled == record_size) {
+			// there is more data, so the held back chunk is not the last
+			if (!_d.emit(_d._buffer.data(), record_size, false, error))
+				return false;
+
+			_d._filled = 0;
+		}
+
+		if (_d._filled == 0 && length > record_size) {
+			// whole chunks with more data behind them are decrypted without copying
+			if (!_d.emit(input, record_size, false, error))
+				return false;
+
+			input += record_size;
+			length -= record_size;
+			continue;
+		}
+
+		const size_t copy = (std::min)(length, record_size - _d._filled);
+		memcpy(_d._buffer.data() + _d._filled, input, copy);
+		_d._filled += copy;
+		input += copy;
+		length -= copy;
+	}
+
+	return true;
+}
+
+bool decrypt_stream::finalize(std::string& error) {
+	error.clear();
+	if (!_d._error.empty()) {
+		error = _d._error;
+		return false;
+	}
+
+	if (_d._header_filled < sizeof(_d._header)) {
+		error = _d._error = "Invalid ciphertext length";
+		return false;
+	}
+
+	if (!_d.emit(_d._buffer.data(), _d._filled, true, error))
+		return false;
+
+	_d._filled = 0;
+	_d._error = "Stream already finalized";
+	return true;
+}
@@ -0,0 +1,27 @@
+//
+// recommended_cipher.cpp - cipher recommendation implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../encrypt.h"
+#include <cryptlib.h>
+#include <cpu.h>
+
+using namespace liblec::leccore;
+
+cipher liblec::leccore::recommended_cipher() {
+#if defined(_M_X64) || defined(_M_IX86)
+	// AES-GCM in hardware outruns ChaCha20-Poly1305, but AES in software is several times slower
+	static const bool aes_in_hardware = CryptoPP::HasAESNI() && CryptoPP::HasCLMUL();
+
+	if (aes_in_hardware)
+		return cipher::aes_gcm;
+#endif
+
+	return cipher::chacha20_poly1305;
+}
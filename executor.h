@@ -0,0 +1,125 @@
+//
+// executor.h - executor interface
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#if defined(LECCORE_EXPORTS)
+#include "leccore.h"
+#else
+#include <liblec/leccore.h>
+#endif
+
+#include <functional>
+
+namespace liblec {
+	namespace leccore {
+		/// <summary>Task executor interface. All the asynchronous leccore classes (hash_file, zip,
+		/// unzip, check_update, download_update etc) submit their work to an executor instead of
+		/// creating their own threads.</summary>
+		/// <remarks>Derive from this class to run leccore's background work on an executor owned by
+		/// your app, then pass it to <see cref="set_default_executor"></see>.</remarks>
+		class leccore_api executor {
+		public:
+			virtual ~executor() {}
+
+			/// <summary>Submit a task for execution.</summary>
+			/// <param name="task">The task to execute.</param>
+			/// <remarks>Every submitted task must eventually be executed. Tasks may block for
+			/// as long as the operation they belong to takes, e.g. a large file download.</remarks>
+			virtual void submit(std::function<void()> task) = 0;
+		};
+
+		/// <summary>Work-stealing thread pool. Each worker thread has its own task queue; a worker
+		/// that runs out of tasks steals from the other workers' queues.</summary>
+		class leccore_api thread_pool : public executor {
+		public:
+			/// <summary>Constructor.</summary>
+			/// <param name="workers">The number of worker threads. Use 0 to use one worker per
+			/// logical processor.</param>
+			/// <param name="affinity_mask">Processor affinity mask. When non-zero each worker is pinned
+			/// to one of the processors in the mask, in turn. Use 0 to let the OS schedule the workers
+			/// on any processor.</param>
+			thread_pool(unsigned int workers = 0,
+				unsigned long long affinity_mask = 0);
+
+			/// <summary>Destructor. Waits for all the pending tasks to complete.</summary>
+			~thread_pool();
+
+			/// <summary>Submit a task for execution.</summary>
+			/// <param name="task">The task to execute.</param>
+			/// <remarks>Tasks submitted from one of the pool's own workers are queued on that
+			/// worker's queue, otherwise the tasks are distributed across the workers in turn.</remarks>
+			void submit(std::function<void()> task) override;
+
+			/// <summary>Get the number of worker threads in the pool.</summary>
+			/// <returns>The number of workers.</returns>
+			unsigned int workers() const;
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Copying an object of this class is not allowed
+			thread_pool(const thread_pool&) = delete;
+			thread_pool& operator=(const thread_pool&) = delete;
+		};
+
+		/// <summary>Cancellation token for asynchronous operations. Copies of a token share the same
+		/// state, so a single token can be handed to several operations to cancel all of them at once.</summary>
+		class leccore_api cancellation_token {
+		public:
+			cancellation_token();
+			cancellation_token(const cancellation_token& other);
+			cancellation_token& operator=(const cancellation_token& other);
+			~cancellation_token();
+
+			/// <summary>Request cancellation of every operation using this token.</summary>
+			/// <remarks>Operations check the token between chunks of work, so they stop shortly after
+			/// this call and not necessarily before it returns. A cancelled token stays cancelled.</remarks>
+			void cancel();
+
+			/// <summary>Check whether cancellation has been requested.</summary>
+			/// <returns>Returns true if <see cref="cancel"></see> has been called on this token or on
+			/// any of its copies.</returns>
+			bool cancelled() const;
+
+		private:
+			class impl;
+			impl* _p_d;
+		};
+
+		/// <summary>Get the executor used by the asynchronous leccore classes.</summary>
+		/// <returns>The executor set using <see cref="set_default_executor"></see>, or the process-wide
+		/// leccore thread pool if none has been set.</returns>
+		/// <remarks>The process-wide thread pool is created on first use, with one worker per logical
+		/// processor.</remarks>
+		executor& leccore_api default_executor();
+
+		/// <summary>Get the executor used by the asynchronous leccore classes whose work is mostly
+		/// spent waiting on the network or the disk: check_update, download_update, zip and unzip.</summary>
+		/// <returns>The executor set using <see cref="set_default_executor"></see>, or a process-wide
+		/// pool that grows as needed if none has been set.</returns>
+		/// <remarks>The growing pool starts a thread for a task whenever none of its threads is idle,
+		/// so these operations start as soon as they are submitted, however many are underway, and
+		/// never hold up the work on the leccore thread pool. Threads that stay idle for a minute
+		/// exit.</remarks>
+		executor& leccore_api blocking_executor();
+
+		/// <summary>Set the executor to be used by the asynchronous leccore classes.</summary>
+		/// <param name="p_executor">A pointer to the executor, or nullptr to revert to the process-wide
+		/// leccore thread pool.</param>
+		/// <remarks>The executor is owned by the caller and must outlive every operation started
+		/// while it is set. Operations that are already underway are not affected. The executor also
+		/// runs the blocking operations listed under <see cref="blocking_executor"></see>, so it must
+		/// not hold up other tasks behind a long download or zip, e.g. by having too few
+		/// threads.</remarks>
+		void leccore_api set_default_executor(executor* p_executor);
+	}
+}
@@ -0,0 +1,216 @@
+//
+// async_task.h - asynchronous task with completion notification
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include "../executor.h"
+
+#include <Windows.h>
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <functional>
+
+namespace liblec {
+	namespace leccore {
+		// Runs a function on an executor, the default executor unless another is given, and lets the
+		// owner find out when it is done by polling, blocking, waiting on a Win32 event or through
+		// a callback.
+		//
+		// The state touched by the worker after the result is published is shared with it, so
+		// the owner may be destroyed from within the completion callback, and the callback may
+		// start the next run.
+		template <typename Result>
+		class async_task {
+			// shared by all the runs of this task
+			struct shared_state {
+				HANDLE event;
+				std::mutex mtx;
+				std::function<void()> callback;
+
+				shared_state() :
+					event(CreateEventA(nullptr, TRUE, FALSE, nullptr)) {}
+				~shared_state() {
+					if (event)
+						CloseHandle(event);
+				}
+			};
+
+			// state of a single run
+			struct run_state {
+				std::promise<Result> promise;
+				std::mutex mtx;
+				std::condition_variable cv;
+				std::thread::id worker_id;
+				bool done = false;
+			};
+
+			// called for each run, so a change of executor applies to the next run
+			executor& (*_get_executor)();
+
+			std::shared_ptr<shared_state> _p_shared;
+			std::shared_ptr<run_state> _p_run;
+			std::future<Result> _fut;
+
+			// _stop is private to each run; _linked is supplied by the owner and may be shared with
+			// other operations, and is picked up as _run_linked when a run starts. cancel() may be
+			// called from any thread, so the tokens are only swapped or read under _token_mtx.
+			mutable std::mutex _token_mtx;
+			cancellation_token _stop;
+			cancellation_token _linked;
+			cancellation_token _run_linked;
+
+		public:
+			// pass blocking_executor for tasks that spend most of their time waiting on I/O
+			async_task(executor& (*get_executor)() = default_executor) :
+				_get_executor(get_executor),
+				_p_shared(std::make_shared<shared_state>()) {}
+			~async_task() { join(); }
+
+			// run func(args...) on the executor; the caller makes sure the previous run is complete
+			template <typename Func, typename... Args>
+			void start(Func&& func, Args&&... args) {
+				auto func_bound = std::bind(std::forward<Func>(func), std::forward<Args>(args)...);
+				auto p_shared = _p_shared;
+				auto p_run = std::make_shared<run_state>();
+
+				_fut = p_run->promise.get_future();
+				_p_run = p_run;
+				{
+					std::lock_guard<std::mutex> lock(_token_mtx);
+					_stop = cancellation_token();
+					_run_linked = _linked;
+				}
+				ResetEvent(p_shared->event);
+
+				auto task = [p_shared, p_run, func_bound]() {
+					{
+						std::lock_guard<std::mutex> lock(p_run->mtx);
+						p_run->worker_id = std::this_thread::get_id();
+					}
+
+					try {
+						p_run->promise.set_value(func_bound());
+					}
+					catch (...) {
+						p_run->promise.set_exception(std::current_exception());
+					}
+
+					SetEvent(p_shared->event);
+
+					std::function<void()> callback;
+					{
+						std::lock_guard<std::mutex> lock(p_shared->mtx);
+						callback = p_shared->callback;
+					}
+
+					if (callback) {
+						try {
+							callback();
+						}
+						catch (...) {
+							// to-do: log
+						}
+					}
+
+					std::lock_guard<std::mutex> lock(p_run->mtx);
+					p_run->done = true;
+					p_run->cv.notify_all();
+				};
+
+				try {
+					_get_executor().submit(task);
+				}
+				catch (...) {
+					// the task will never run; complete the run with the error instead
+					p_run->promise.set_exception(std::current_exception());
+					SetEvent(p_shared->event);
+
+					std::lock_guard<std::mutex> lock(p_run->mtx);
+					p_run->done = true;
+					p_run->cv.notify_all();
+				}
+			}
+
+			// whether the result has been retrieved or a run is pending
+			bool valid() const {
+				return _fut.valid();
+			}
+
+			// whether the function is still running
+			bool running() const {
+				if (_fut.valid())
+					return _fut.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready;
+				else
+					return false;
+			}
+
+			// wait for the function to return, for up to the given time
+			bool wait(unsigned long long milliseconds) const {
+				if (_fut.valid())
+					return _fut.wait_for(std::chrono::milliseconds{ milliseconds }) == std::future_status::ready;
+				else
+					return true;
+			}
+
+			// wait for the current run to finish, including the completion callback
+			void join() {
+				auto p_run = _p_run;
+				if (!p_run)
+					return;
+
+				std::unique_lock<std::mutex> lock(p_run->mtx);
+
+				// called from within the completion callback
+				if (p_run->worker_id == std::this_thread::get_id())
+					return;
+
+				p_run->cv.wait(lock, [&p_run]() { return p_run->done; });
+			}
+
+			// retrieve the result; only call this once running() returns false
+			Result get() {
+				ResetEvent(_p_shared->event);
+				return _fut.get();
+			}
+
+			// request cancellation of the current run
+			void cancel() {
+				std::lock_guard<std::mutex> lock(_token_mtx);
+				_stop.cancel();
+			}
+
+			// link a token that is checked in addition to the run's own one, from the next run on
+			void link(const cancellation_token& token) {
+				std::lock_guard<std::mutex> lock(_token_mtx);
+				_linked = token;
+			}
+
+			// whether the function should stop at its next opportunity
+			bool cancelled() const {
+				std::lock_guard<std::mutex> lock(_token_mtx);
+				return _stop.cancelled() || _run_linked.cancelled();
+			}
+
+			void on_complete(std::function<void()> callback) {
+				std::lock_guard<std::mutex> lock(_p_shared->mtx);
+				_p_shared->callback = callback;
+			}
+
+			void* completion_event() const {
+				return _p_shared->event;
+			}
+		};
+	}
+}
@@ -0,0 +1,110 @@
+//
+// cancellable_streambuf.h - stream buffers that stop transferring data on cancellation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include <streambuf>
+#include <functional>
+#include <vector>
+
+namespace liblec {
+	namespace leccore {
+		// Reads from another stream buffer and reports end of file once cancelled. Used to stop
+		// third party code that consumes a whole stream (e.g. Poco's zip decompressor) between chunks.
+		class cancellable_istreambuf : public std::streambuf {
+			std::streambuf& _source;
+			std::function<bool()> _cancelled;
+			std::vector<char> _buffer;
+
+		protected:
+			int_type underflow() override {
+				if (gptr() < egptr())
+					return traits_type::to_int_type(*gptr());
+
+				if (_cancelled())
+					return traits_type::eof();
+
+				const auto read = _source.sgetn(_buffer.data(), _buffer.size());
+				if (read <= 0)
+					return traits_type::eof();
+
+				setg(_buffer.data(), _buffer.data(), _buffer.data() + read);
+				return traits_type::to_int_type(*gptr());
+			}
+
+			pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+				std::ios_base::openmode which) override {
+				// the source is positioned at the end of the buffered data
+				if (dir == std::ios_base::cur)
+					off -= egptr() - gptr();
+
+				setg(_buffer.data(), _buffer.data(), _buffer.data());
+				return _source.pubseekoff(off, dir, which);
+			}
+
+			pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+				setg(_buffer.data(), _buffer.data(), _buffer.data());
+				return _source.pubseekpos(pos, which);
+			}
+
+		public:
+			cancellable_istreambuf(std::streambuf& source, std::function<bool()> cancelled,
+				size_t buffer_size = 64 * 1024) :
+				_source(source),
+				_cancelled(cancelled),
+				_buffer(buffer_size) {
+				setg(_buffer.data(), _buffer.data(), _buffer.data());
+			}
+		};
+
+		// Writes to another stream buffer and fails every write once cancelled, putting the
+		// stream writing to it into a failed state.
+		class cancellable_ostreambuf : public std::streambuf {
+			std::streambuf& _target;
+			std::function<bool()> _cancelled;
+
+		protected:
+			int_type overflow(int_type ch) override {
+				if (traits_type::eq_int_type(ch, traits_type::eof()))
+					return traits_type::not_eof(ch);
+
+				if (_cancelled())
+					return traits_type::eof();
+
+				return _target.sputc(traits_type::to_char_type(ch));
+			}
+
+			std::streamsize xsputn(const char* s, std::streamsize count) override {
+				if (_cancelled())
+					return 0;
+
+				return _target.sputn(s, count);
+			}
+
+			pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+				std::ios_base::openmode which) override {
+				return _target.pubseekoff(off, dir, which);
+			}
+
+			pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+				return _target.pubseekpos(pos, which);
+			}
+
+			int sync() override {
+				return _target.pubsync();
+			}
+
+		public:
+			cancellable_ostreambuf(std::streambuf& target, std::function<bool()> cancelled) :
+				_target(target),
+				_cancelled(cancelled) {}
+		};
+	}
+}
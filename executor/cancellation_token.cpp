@@ -0,0 +1,58 @@
+//
+// cancellation_token.cpp - cancellation token implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../executor.h"
+#include <atomic>
+
+using namespace liblec::leccore;
+
+// State shared by all the copies of a token.
+class cancellation_token::impl {
+public:
+	std::atomic<bool> _cancelled;
+	std::atomic<long> _references;
+
+	impl() :
+		_cancelled(false),
+		_references(1) {}
+	~impl() {}
+
+	static void release(impl* p_impl) {
+		if (--p_impl->_references == 0)
+			delete p_impl;
+	}
+};
+
+cancellation_token::cancellation_token() : _p_d(new impl()) {}
+
+cancellation_token::cancellation_token(const cancellation_token& other) :
+	_p_d(other._p_d) {
+	_p_d->_references++;
+}
+
+cancellation_token& cancellation_token::operator=(const cancellation_token& other) {
+	if (_p_d != other._p_d) {
+		other._p_d->_references++;
+		impl::release(_p_d);
+		_p_d = other._p_d;
+	}
+
+	return *this;
+}
+
+cancellation_token::~cancellation_token() { impl::release(_p_d); }
+
+void cancellation_token::cancel() {
+	_p_d->_cancelled = true;
+}
+
+bool cancellation_token::cancelled() const {
+	return _p_d->_cancelled;
+}
@@ -0,0 +1,109 @@
+//
+// executor.cpp - default executor implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../executor.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+
+namespace {
+	std::atomic<liblec::leccore::executor*> _p_default_executor = nullptr;
+
+	liblec::leccore::thread_pool& leccore_thread_pool() {
+		// deliberately never destroyed: joining worker threads while the dll is being
+		// unloaded would have to happen under the loader lock
+		static liblec::leccore::thread_pool* p_pool = new liblec::leccore::thread_pool();
+		return *p_pool;
+	}
+
+	// Runs tasks that spend most of their time blocked, e.g. downloads. A task that finds no idle
+	// thread gets a new one, so it starts right away instead of waiting for the tasks ahead of it,
+	// and threads that stay idle for a while exit.
+	class blocking_pool : public liblec::leccore::executor {
+		std::mutex _mtx;
+		std::condition_variable _cv;
+		std::deque<std::function<void()>> _tasks;
+		size_t _idle = 0;
+
+		void run() {
+			std::unique_lock<std::mutex> lock(_mtx);
+
+			for (;;) {
+				if (_tasks.empty()) {
+					_idle++;
+					const bool woken = _cv.wait_for(lock, std::chrono::seconds(60),
+						[this]() { return !_tasks.empty(); });
+					_idle--;
+
+					if (!woken)
+						return;
+				}
+
+				auto task = std::move(_tasks.front());
+				_tasks.pop_front();
+
+				lock.unlock();
+				task();
+				lock.lock();
+			}
+		}
+
+	public:
+		void submit(std::function<void()> task) override {
+			std::unique_lock<std::mutex> lock(_mtx);
+			_tasks.push_back(std::move(task));
+
+			if (_tasks.size() <= _idle) {
+				lock.unlock();
+				_cv.notify_one();
+				return;
+			}
+
+			try {
+				std::thread([this]() { run(); }).detach();
+			}
+			catch (...) {
+				_tasks.pop_back();
+				throw;
+			}
+		}
+	};
+
+	blocking_pool& leccore_blocking_pool() {
+		// deliberately never destroyed, like the thread pool
+		static blocking_pool* p_pool = new blocking_pool();
+		return *p_pool;
+	}
+}
+
+liblec::leccore::executor& liblec::leccore::default_executor() {
+	executor* p_executor = _p_default_executor;
+
+	if (p_executor)
+		return *p_executor;
+
+	return leccore_thread_pool();
+}
+
+liblec::leccore::executor& liblec::leccore::blocking_executor() {
+	executor* p_executor = _p_default_executor;
+
+	if (p_executor)
+		return *p_executor;
+
+	return leccore_blocking_pool();
+}
+
+void liblec::leccore::set_default_executor(executor* p_executor) {
+	_p_default_executor = p_executor;
+}
@@ -0,0 +1,97 @@
+//
+// parallel_for.cpp - data parallel loop implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "parallel_for.h"
+#include "../executor.h"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <exception>
+
+namespace {
+	// shared by the caller and the helpers; helpers that outlive the loop only touch this
+	struct loop_state {
+		size_t count;
+		const std::function<void(size_t)>* p_func;
+
+		std::atomic<size_t> next;
+		std::atomic<size_t> done;
+
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::exception_ptr error;
+
+		loop_state(size_t count, const std::function<void(size_t)>* p_func) :
+			count(count),
+			p_func(p_func),
+			next(0),
+			done(0) {}
+
+		// run indices until there are none left to claim
+		void work() {
+			size_t completed = 0;
+
+			for (size_t index = next++; index < count; index = next++) {
+				try {
+					(*p_func)(index);
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> lock(mtx);
+					if (!error)
+						error = std::current_exception();
+				}
+
+				completed++;
+			}
+
+			if (completed && (done += completed) == count) {
+				std::lock_guard<std::mutex> lock(mtx);
+				cv.notify_all();
+			}
+		}
+	};
+}
+
+void liblec::leccore::parallel_for(size_t count, const std::function<void(size_t)>& func,
+	unsigned int max_threads) {
+	if (count == 0)
+		return;
+
+	if (max_threads == 0)
+		max_threads = std::thread::hardware_concurrency();
+
+	size_t helpers = max_threads > 1 ? max_threads - 1 : 0;
+	if (helpers > count - 1)
+		helpers = count - 1;
+
+	auto p_state = std::make_shared<loop_state>(count, &func);
+
+	for (size_t i = 0; i < helpers; i++) {
+		try {
+			default_executor().submit([p_state]() { p_state->work(); });
+		}
+		catch (...) {
+			// run with the helpers submitted so far
+			break;
+		}
+	}
+
+	p_state->work();
+
+	// the remaining indices have been claimed by helpers that are running them
+	std::unique_lock<std::mutex> lock(p_state->mtx);
+	p_state->cv.wait(lock, [&p_state]() { return p_state->done == p_state->count; });
+
+	if (p_state->error)
+		std::rethrow_exception(p_state->error);
+}
@@ -0,0 +1,29 @@
+//
+// parallel_for.h - data parallel loop on the default executor
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include <functional>
+
+namespace liblec {
+	namespace leccore {
+		// Calls func(0) ... func(count - 1) on the calling thread and on helpers submitted to the
+		// default executor, and returns once every call has returned. The indices are claimed one at
+		// a time, so a helper that only gets to run late finds nothing left to do, and the caller never
+		// waits on a task that has not started. It is therefore safe to call from within a task running
+		// on the default executor, however busy it is.
+		//
+		// max_threads limits the number of threads working on the loop, the caller included; use 0 for
+		// one per logical processor. The first exception thrown by func is rethrown once all the calls
+		// have returned.
+		void parallel_for(size_t count, const std::function<void(size_t)>& func,
+			unsigned int max_threads = 0);
+	}
+}
@@ -0,0 +1,186 @@
+//
+// thread_pool.cpp - work-stealing thread pool implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../executor.h"
+
+#include <Windows.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+
+using namespace liblec::leccore;
+
+class thread_pool::impl {
+	struct worker_queue {
+		std::mutex mtx;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<worker_queue>> _queues;
+	std::vector<std::thread> _threads;
+
+	// sleeping workers wait on this until there are tasks to run
+	std::mutex _sleep_mtx;
+	std::condition_variable _sleep_cv;
+	std::atomic<size_t> _pending;
+	bool _stop;
+
+	// round-robin index for tasks submitted from outside the pool
+	std::atomic<size_t> _next;
+
+	// the pool and queue index of the calling thread, if it is a worker
+	static thread_local impl* _p_current_pool;
+	static thread_local size_t _current_index;
+
+	bool pop_local(size_t index, std::function<void()>& task) {
+		worker_queue& queue = *_queues[index];
+		std::lock_guard<std::mutex> lock(queue.mtx);
+
+		if (queue.tasks.empty())
+			return false;
+
+		// newest first, for cache locality
+		task = std::move(queue.tasks.back());
+		queue.tasks.pop_back();
+		return true;
+	}
+
+	bool steal(size_t index, std::function<void()>& task) {
+		for (size_t i = 1; i < _queues.size(); i++) {
+			worker_queue& queue = *_queues[(index + i) % _queues.size()];
+			std::unique_lock<std::mutex> lock(queue.mtx, std::try_to_lock);
+
+			if (!lock.owns_lock() || queue.tasks.empty())
+				continue;
+
+			// oldest first, to take the work the owner is least likely to get to soon
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			return true;
+		}
+
+		return false;
+	}
+
+	void worker_func(size_t index) {
+		_p_current_pool = this;
+		_current_index = index;
+
+		while (true) {
+			std::function<void()> task;
+
+			if (pop_local(index, task) || steal(index, task)) {
+				_pending--;
+
+				try {
+					task();
+				}
+				catch (...) {
+					// tasks are expected to handle their own errors; don't let one take down the worker
+				}
+
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(_sleep_mtx);
+			if (_pending == 0 && _stop)
+				break;
+
+			_sleep_cv.wait(lock, [this]() { return _pending > 0 || _stop; });
+
+			if (_pending == 0 && _stop)
+				break;
+		}
+
+		_p_current_pool = nullptr;
+	}
+
+public:
+	impl(unsigned int workers, unsigned long long affinity_mask) :
+		_pending(0),
+		_stop(false),
+		_next(0) {
+		if (workers == 0)
+			workers = std::thread::hardware_concurrency();
+
+		if (workers == 0)
+			workers = 1;
+
+		for (unsigned int i = 0; i < workers; i++)
+			_queues.push_back(std::make_unique<worker_queue>());
+
+		// processors in the affinity mask, in order
+		std::vector<DWORD_PTR> processors;
+		for (unsigned int bit = 0; bit < sizeof(DWORD_PTR) * 8; bit++) {
+			const DWORD_PTR processor = static_cast<DWORD_PTR>(1) << bit;
+			if (affinity_mask & processor)
+				processors.push_back(processor);
+		}
+
+		for (unsigned int i = 0; i < workers; i++) {
+			_threads.emplace_back(&impl::worker_func, this, i);
+
+			if (!processors.empty())
+				SetThreadAffinityMask(_threads.back().native_handle(), processors[i % processors.size()]);
+		}
+	}
+
+	~impl() {
+		{
+			std::lock_guard<std::mutex> lock(_sleep_mtx);
+			_stop = true;
+		}
+		_sleep_cv.notify_all();
+
+		for (auto& thread : _threads)
+			thread.join();
+	}
+
+	void submit(std::function<void()> task) {
+		const size_t index = _p_current_pool == this ?
+			_current_index : _next++ % _queues.size();
+
+		{
+			worker_queue& queue = *_queues[index];
+			std::lock_guard<std::mutex> lock(queue.mtx);
+			queue.tasks.push_back(std::move(task));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_sleep_mtx);
+			_pending++;
+		}
+		_sleep_cv.notify_one();
+	}
+
+	unsigned int workers() const {
+		return static_cast<unsigned int>(_threads.size());
+	}
+};
+
+thread_local thread_pool::impl* thread_pool::impl::_p_current_pool = nullptr;
+thread_local size_t thread_pool::impl::_current_index = 0;
+
+thread_pool::thread_pool(unsigned int workers, unsigned long long affinity_mask) :
+	_d(*new impl(workers, affinity_mask)) {}
+thread_pool::~thread_pool() { delete& _d; }
+
+void thread_pool::submit(std::function<void()> task) {
+	_d.submit(std::move(task));
+}
+
+unsigned int thread_pool::workers() const {
+	return _d.workers();
+}
@@ -12,12 +12,17 @@
 
 #if defined(LECCORE_EXPORTS)
 #include "leccore.h"
+#include "executor.h"
 #else
 #include <liblec/leccore.h>
+#include <liblec/leccore/executor.h>
 #endif
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <array>
+#include <functional>
 #include <map>
 
 namespace liblec {
@@ -29,25 +34,300 @@ namespace liblec {
 			/// <param name="input">The string that is to be hashed.</param>
 			/// <returns>The SHA256 hash of <see cref="input"></see>.</returns>
 			[[nodiscard]]
+			static std::string sha256(std::string_view input);
+
+			/// <summary>SHA256 hash.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <returns>The SHA256 hash of <see cref="input"></see>.</returns>
+			/// <remarks>Forwards to the string_view overload. Programs built against earlier
+			/// versions of the library import this one.</remarks>
+			[[nodiscard]]
 			static std::string sha256(const std::string& input);
 
+			/// <summary>SHA256 hash of a null-terminated string.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <returns>The SHA256 hash of <see cref="input"></see>.</returns>
+			/// <remarks>A string literal would otherwise match both of the overloads above.</remarks>
+			[[nodiscard]]
+			static std::string sha256(const char* input) {
+				return sha256(std::string_view(input));
+			}
+
+			/// <summary>SHA256 hash, as raw bytes.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <param name="digest">Receives the 32 byte digest.</param>
+			/// <remarks>Nothing is allocated. Use <see cref="to_hex"></see> to format the digest.</remarks>
+			static void sha256(std::string_view input,
+				std::array<unsigned char, 32>& digest);
+
+			/// <summary>SHA256 hash of many strings at once.</summary>
+			/// <param name="inputs">The strings.</param>
+			/// <param name="digests">A buffer of at least 32 bytes per string that receives
+			/// the raw 32 byte digests, one after the other, in the same order as the strings.</param>
+			/// <remarks>Use this to hash large numbers of short strings. Unlike the hex overload nothing is
+			/// allocated per string, and processors without the SHA extensions hash eight strings at a time
+			/// with AVX2.</remarks>
+			static void sha256(const std::vector<std::string_view>& inputs,
+				unsigned char* digests);
+
+			/// <summary>SHA512 hash.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <returns>The SHA512 hash of <see cref="input"></see>.</returns>
+			[[nodiscard]]
+			static std::string sha512(std::string_view input);
+
 			/// <summary>SHA512 hash.</summary>
 			/// <param name="input">The string that is to be hashed.</param>
 			/// <returns>The SHA512 hash of <see cref="input"></see>.</returns>
+			/// <remarks>Forwards to the string_view overload. Programs built against earlier
+			/// versions of the library import this one.</remarks>
 			[[nodiscard]]
 			static std::string sha512(const std::string& input);
 
+			/// <summary>SHA512 hash of a null-terminated string.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <returns>The SHA512 hash of <see cref="input"></see>.</returns>
+			/// <remarks>A string literal would otherwise match both of the overloads above.</remarks>
+			[[nodiscard]]
+			static std::string sha512(const char* input) {
+				return sha512(std::string_view(input));
+			}
+
+			/// <summary>SHA512 hash, as raw bytes.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <param name="digest">Receives the 64 byte digest.</param>
+			/// <remarks>Nothing is allocated.</remarks>
+			static void sha512(std::string_view input,
+				std::array<unsigned char, 64>& digest);
+
+			/// <summary>BLAKE3 hash.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <returns>The 256 bit BLAKE3 hash of <see cref="input"></see>.</returns>
+			/// <remarks>Large strings are hashed on all the processors at once.</remarks>
+			[[nodiscard]]
+			static std::string blake3(std::string_view input);
+
+			/// <summary>BLAKE3 hash, as raw bytes.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <param name="digest">Receives the 32 byte digest.</param>
+			/// <remarks>Nothing is allocated for strings of less than 256 KB; larger ones are hashed on
+			/// several processors at once.</remarks>
+			static void blake3(std::string_view input,
+				std::array<unsigned char, 32>& digest);
+
+			/// <summary>XXH3 64 bit hash.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <returns>The XXH3 64 bit hash of <see cref="input"></see>.</returns>
+			/// <remarks>This is not a cryptographic hash.</remarks>
+			[[nodiscard]]
+			static std::string xxh3_64(std::string_view input);
+
+			/// <summary>XXH3 64 bit hash, as raw bytes.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <param name="digest">Receives the 8 byte digest, most significant byte first.</param>
+			/// <remarks>Nothing is allocated. This is not a cryptographic hash.</remarks>
+			static void xxh3_64(std::string_view input,
+				std::array<unsigned char, 8>& digest);
+
+			/// <summary>XXH3 128 bit hash.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <returns>The XXH3 128 bit hash of <see cref="input"></see>.</returns>
+			/// <remarks>This is not a cryptographic hash.</remarks>
+			[[nodiscard]]
+			static std::string xxh3_128(std::string_view input);
+
+			/// <summary>XXH3 128 bit hash, as raw bytes.</summary>
+			/// <param name="input">The string that is to be hashed.</param>
+			/// <param name="digest">Receives the 16 byte digest, most significant byte first.</param>
+			/// <remarks>Nothing is allocated. This is not a cryptographic hash.</remarks>
+			static void xxh3_128(std::string_view input,
+				std::array<unsigned char, 16>& digest);
+
+			/// <summary>CRC32C checksum.</summary>
+			/// <param name="input">The string that is to be checksummed.</param>
+			/// <returns>The CRC32C checksum of <see cref="input"></see>, most significant byte first.</returns>
+			/// <remarks>This is not a cryptographic hash.</remarks>
+			[[nodiscard]]
+			static std::string crc32c(std::string_view input);
+
+			/// <summary>CRC32C checksum, as raw bytes.</summary>
+			/// <param name="input">The string that is to be checksummed.</param>
+			/// <param name="digest">Receives the 4 byte checksum, most significant byte first.</param>
+			/// <remarks>Nothing is allocated. This is not a cryptographic hash.</remarks>
+			static void crc32c(std::string_view input,
+				std::array<unsigned char, 4>& digest);
+
+			/// <summary>Format raw bytes, e.g. a digest, as lowercase hex.</summary>
+			/// <param name="data">A pointer to the bytes.</param>
+			/// <param name="length">The number of bytes.</param>
+			/// <param name="hex">A buffer of at least 2 * <see cref="length"></see> characters that
+			/// receives the hex. No terminating null is written.</param>
+			/// <remarks>Nothing is allocated.</remarks>
+			static void to_hex(const unsigned char* data,
+				size_t length,
+				char* hex);
+
+			/// <summary>Format raw bytes, e.g. a digest, as lowercase hex.</summary>
+			/// <param name="data">A pointer to the bytes.</param>
+			/// <param name="length">The number of bytes.</param>
+			/// <returns>The hex string, the same as the one returned by the string overloads of the
+			/// hashes.</returns>
+			[[nodiscard]]
+			static std::string to_hex(const unsigned char* data,
+				size_t length);
+
+			/// <summary>Format a digest as lowercase hex.</summary>
+			/// <param name="digest">The digest.</param>
+			/// <returns>The hex string.</returns>
+			template <size_t size>
+			[[nodiscard]]
+			static std::string to_hex(const std::array<unsigned char, size>& digest) {
+				return to_hex(digest.data(), size);
+			}
+
 			/// <summary>Generate a random string.</summary>
 			/// <param name="length">The length of the random string.</param>
 			/// <returns>A random string of the specified <see cref="length"></see>.</returns>
+			/// <remarks>The bytes come from the same generator as <see cref="random_bytes"></see>.</remarks>
 			[[nodiscard]]
 			static std::string random_string(int length);
 
+			/// <summary>Fill a buffer with cryptographically secure random bytes.</summary>
+			/// <param name="buffer">A pointer to the buffer.</param>
+			/// <param name="length">The number of bytes to write.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Each thread has its own generator, seeded from the operating system the first
+			/// time the thread asks for random bytes and reseeded after every 1 MB of output or every 10
+			/// minutes, whichever comes first. All other calls are served without going to the operating
+			/// system or taking a lock, so this is cheap enough to call in a loop, e.g. for tokens and
+			/// salts.</remarks>
+			static bool random_bytes(unsigned char* buffer,
+				size_t length);
+
 			/// <summary>Make a universally unique identifier (uuid).</summary>
 			/// <returns>The uuid string.</returns>
+			/// <remarks>This is a version 4 (random) uuid.</remarks>
 			static std::string uuid();
+
+			/// <summary>Universally unique identifier (uuid) version.</summary>
+			enum class uuid_version {
+				/// <summary>Version 4. All but six of the bits are random.</summary>
+				v4,
+
+				/// <summary>Version 7. Starts with the time in milliseconds, followed by a counter and
+				/// random bits. Uuids made later sort after uuids made earlier, so as database keys they
+				/// are inserted at the end of the index rather than at random places in it.</summary>
+				v7,
+			};
+
+			/// <summary>Make a universally unique identifier (uuid).</summary>
+			/// <param name="version">The uuid version, as defined in <see cref="uuid_version"></see>.</param>
+			/// <returns>The uuid string, in lowercase, e.g. "0190b6b2-3f4c-7a41-9d2e-5b8c1f0a7e63".</returns>
+			[[nodiscard]]
+			static std::string uuid(uuid_version version);
+
+			/// <summary>Make many universally unique identifiers (uuids) at once.</summary>
+			/// <param name="version">The uuid version, as defined in <see cref="uuid_version"></see>.</param>
+			/// <param name="count">The number of uuids to make.</param>
+			/// <param name="text">A buffer of at least 36 * <see cref="count"></see> characters that
+			/// receives the uuids, one after the other, without separators or a terminating null.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Nothing is allocated. Version 7 uuids made by a single call are in ascending
+			/// order, and so are the ones made by consecutive calls within the process, even
+			/// when more than 4096 are made in the same millisecond.</remarks>
+			static bool uuids(uuid_version version,
+				size_t count,
+				char* text);
+		};
+
+		/// <summary>Keyed-hash message authentication code (HMAC) class.</summary>
+		/// <remarks>The key is absorbed into the inner and outer hash states once, at construction.
+		/// Each message then starts from a copy of those states, so the key costs nothing per message
+		/// and nothing is allocated. An object can be used from several threads at the same time.</remarks>
+		class leccore_api hmac {
+		public:
+			/// <summary>HMAC hash algorithm.</summary>
+			enum class algorithm {
+				/// <summary>HMAC-SHA256, with a 32 byte code.</summary>
+				sha256,
+
+				/// <summary>HMAC-SHA512, with a 64 byte code.</summary>
+				sha512,
+			};
+
+			/// <summary>Constructor.</summary>
+			/// <param name="key">The secret key. Keys longer than the hash's block size (64 bytes for
+			/// SHA256 and 128 bytes for SHA512) are hashed first, as the standard requires.</param>
+			/// <param name="algo">The hash algorithm, as defined in <see cref="algorithm"></see>.</param>
+			/// <remarks>Throws std::invalid_argument if the algorithm is not one of those defined.</remarks>
+			hmac(const std::string& key,
+				algorithm algo = algorithm::sha256);
+			~hmac();
+
+			/// <summary>Get the size of the authentication code.</summary>
+			/// <returns>The size of the code, in bytes.</returns>
+			unsigned int mac_size() const;
+
+			/// <summary>Compute the authentication code of a message.</summary>
+			/// <param name="data">A pointer to the message.</param>
+			/// <param name="length">The length of the message, in bytes.</param>
+			/// <param name="mac">A buffer of at least <see cref="mac_size"></see> bytes that receives
+			/// the code.</param>
+			void compute(const void* data,
+				size_t length,
+				unsigned char* mac) const;
+
+			/// <summary>Compute the authentication code of a message.</summary>
+			/// <param name="message">The message.</param>
+			/// <returns>The code, in lowercase hex.</returns>
+			[[nodiscard]]
+			std::string compute(const std::string& message) const;
+
+			/// <summary>Compute the authentication codes of many messages at once.</summary>
+			/// <param name="messages">The messages.</param>
+			/// <param name="macs">A buffer of at least <see cref="mac_size"></see> bytes per message that
+			/// receives the codes, one after the other, in the same order as the messages.</param>
+			void compute(const std::vector<std::string_view>& messages,
+				unsigned char* macs) const;
+
+			/// <summary>Verify the authentication code of a message.</summary>
+			/// <param name="data">A pointer to the message.</param>
+			/// <param name="length">The length of the message, in bytes.</param>
+			/// <param name="mac">A pointer to the code to verify.</param>
+			/// <param name="mac_length">The length of the code, in bytes. Codes of any other length
+			/// than <see cref="mac_size"></see> are rejected.</param>
+			/// <returns>Returns true if the code is correct, else false.</returns>
+			/// <remarks>The codes are compared in constant time, so the time taken does not reveal how
+			/// much of a forged code is correct.</remarks>
+			[[nodiscard]]
+			bool verify(const void* data,
+				size_t length,
+				const unsigned char* mac,
+				size_t mac_length) const;
+
+			/// <summary>Verify the authentication codes of many messages at once.</summary>
+			/// <param name="messages">The messages.</param>
+			/// <param name="macs">The codes to verify, <see cref="mac_size"></see> bytes each, one after
+			/// the other, in the same order as the messages.</param>
+			/// <param name="results">An array of at least one element per message that receives the
+			/// outcome for each message; true if its code is correct, else false.</param>
+			/// <returns>The number of messages whose code is correct.</returns>
+			size_t verify(const std::vector<std::string_view>& messages,
+				const unsigned char* macs,
+				bool* results) const;
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Default constructor and copying an object of this class are not allowed
+			hmac() = delete;
+			hmac(const hmac&) = delete;
+			hmac& operator=(const hmac&) = delete;
 		};
 
+		class hash_cache;
+
 		/// <summary>File hashing class.</summary>
 		class leccore_api hash_file {
 		public:
@@ -61,15 +341,83 @@ namespace liblec {
 
 				/// <summary>SHA512 hash.</summary>
 				sha512,
+
+				/// <summary>BLAKE3 hash, 256 bits. Unlike the SHA hashes, large files are hashed on all
+				/// the processors at once.</summary>
+				blake3,
+
+				/// <summary>XXH3 64 bit hash. Not cryptographic, but many times faster than the SHA hashes,
+				/// so best used for change detection.</summary>
+				xxh3_64,
+
+				/// <summary>XXH3 128 bit hash. Not cryptographic; as fast as <see cref="xxh3_64"></see>
+				/// with fewer collisions.</summary>
+				xxh3_128,
+
+				/// <summary>CRC32C checksum, using the processor's crc32 instruction where available.
+				/// Not cryptographic.</summary>
+				crc32c,
 			};
 
-			/// <summary>Hash results. Key is the algorithm and value is the hash.</summary>
+			/// <summary>Hash results. Key is the algorithm and value is the hash, in the format set
+			/// with <see cref="set_digest_format"></see>: lowercase hex by default, or the raw digest
+			/// bytes.</summary>
 			/// <remarks>Allows running multiple hashes in one sweep, which is far much more efficient
 			/// than running one hash at a time because in that case the file data has to be read again.
 			/// </remarks>
 			using hash_results = std::map<algorithm, std::string>;
 
-			
+			/// <summary>How the hashes are returned.</summary>
+			enum class digest_format {
+				/// <summary>Lowercase hex, e.g. 64 characters for SHA256.</summary>
+				hex,
+
+				/// <summary>The raw digest bytes, e.g. 32 bytes for SHA256. Use
+				/// <see cref="hash_string::to_hex"></see> to format them when needed.</summary>
+				raw,
+			};
+
+			/// <summary>How the file data is read.</summary>
+			enum class read_mode {
+				/// <summary>Pick the mode from the size of the file: files of up to 256 MB are mapped,
+				/// larger files are read directly.</summary>
+				automatic,
+
+				/// <summary>Read through a C++ file stream in 1 MB chunks.</summary>
+				buffered,
+
+				/// <summary>Map the file into memory, 64 MB at a time, and hash straight from the mapped
+				/// pages. No data is copied, except for BLAKE3, which hashes on several threads and is
+				/// given a copy so that a read error in the mapped pages is always caught.</summary>
+				mapped,
+
+				/// <summary>Read in large sector-aligned blocks, bypassing the system file cache, with the
+				/// next block being read while the current one is hashed. Best for files far larger than
+				/// the file cache, which would otherwise evict everything else from it.</summary>
+				direct,
+			};
+
+			/// <summary>Set how the file data is read.</summary>
+			/// <param name="mode">The read mode, as defined in <see cref="read_mode"></see>. The default
+			/// is <see cref="read_mode::automatic"></see>.</param>
+			/// <remarks>Set the read mode before calling <see cref="start"></see>. Every mode produces the
+			/// same hashes.</remarks>
+			void set_read_mode(read_mode mode);
+
+			/// <summary>Set how the hashes are returned.</summary>
+			/// <param name="format">The format, as defined in <see cref="digest_format"></see>. The
+			/// default is <see cref="digest_format::hex"></see>.</param>
+			/// <remarks>Set the format before calling <see cref="start"></see>.</remarks>
+			void set_digest_format(digest_format format);
+
+			/// <summary>Set a persistent cache to consult before reading the file.</summary>
+			/// <param name="p_cache">A pointer to an open <see cref="hash_cache"></see>, or nullptr to
+			/// stop using one. The cache must outlive any hashing that uses it.</param>
+			/// <remarks>When the file is unchanged since it was last hashed, the hashes are taken from the
+			/// cache and the file is not read at all. Set the cache before calling <see cref="start"></see>.
+			/// </remarks>
+			void set_cache(hash_cache* p_cache);
+
 			/// <summary>Start hashing.</summary>
 			/// <param name="fullpath">The full path to the file, including the extension.</param>
 			/// <param name="algorithms">The list of algorithms to use.</param>
@@ -94,6 +442,37 @@ namespace liblec {
 			bool result(hash_results& results,
 				std::string& error);
 
+			/// <summary>Set a function to be called when hashing completes.</summary>
+			/// <param name="callback">The function to call. It is called on the thread that did the
+			/// hashing, right after the result becomes available, so it can call <see cref="result"></see>.</param>
+			/// <remarks>Set the callback before calling <see cref="start"></see>.</remarks>
+			void on_complete(std::function<void()> callback);
+
+			/// <summary>Wait for hashing to complete.</summary>
+			/// <param name="timeout_milliseconds">The maximum time to wait, in milliseconds.</param>
+			/// <returns>Returns true if hashing is complete, else false if the timeout elapsed first.</returns>
+			bool wait(unsigned long long timeout_milliseconds);
+
+			/// <summary>Get the completion event.</summary>
+			/// <returns>A handle to a manual-reset Win32 event object (HANDLE) that is signaled when
+			/// hashing completes. It is reset by <see cref="start"></see> and <see cref="result"></see>.</returns>
+			/// <remarks>Use this with WaitForMultipleObjects, MsgWaitForMultipleObjects or
+			/// RegisterWaitForSingleObject to wake your event loop exactly when hashing completes
+			/// instead of polling. The handle is owned by this object; do not close it.</remarks>
+			void* completion_event();
+
+			/// <summary>Cancel hashing.</summary>
+			/// <remarks>This method returns immediately. Hashing stops before the next chunk of the file is
+			/// read and <see cref="result"></see> then returns false with the error "Operation cancelled".
+			/// Destroying this object also cancels any operation that is still underway.</remarks>
+			void cancel();
+
+			/// <summary>Set a cancellation token to observe in addition to <see cref="cancel"></see>.</summary>
+			/// <param name="token">The token, as defined in <see cref="cancellation_token"></see>. Share one
+			/// token between several objects to cancel all of their operations at once.</param>
+			/// <remarks>The token applies to operations started after this call.</remarks>
+			void set_cancellation_token(const cancellation_token& token);
+
 		private:
 			class impl;
 			impl& _d;
@@ -102,5 +481,291 @@ namespace liblec {
 			hash_file(const hash_file&) = delete;
 			hash_file& operator=(const hash_file&) = delete;
 		};
+
+		/// <summary>Persistent file hash cache. Remembers the hashes of files on disk so that files
+		/// which have not changed since they were last hashed need not be read again.</summary>
+		/// <remarks>Entries are keyed by the file's path and the algorithm, and are only used while the
+		/// file's size, last write time and file ID (the volume serial number and file index, the Windows
+		/// equivalent of an inode) still match, so a file that is modified, replaced or renamed over is
+		/// hashed afresh. Checking an entry costs a single file open, without reading any data.
+		/// The cache is an SQLite database in WAL mode, so several processes can share the same cache
+		/// file at the same time; one object can also be shared by several hashing objects within a
+		/// process. Entries live on disk, and only a small page cache is kept in memory.</remarks>
+		class leccore_api hash_cache {
+		public:
+			/// <summary>Constructor.</summary>
+			/// <param name="fullpath">The full path to the cache file, e.g.
+			/// "C:\ProgramData\com.github.alecmus\PC Info\hashes.db". The file is created
+			/// if it does not exist.</param>
+			hash_cache(const std::string& fullpath);
+			~hash_cache();
+
+			/// <summary>Open the cache.</summary>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>A cache that is not open is ignored by the hashing objects.</remarks>
+			bool open(std::string& error);
+
+			/// <summary>Check whether the cache is open.</summary>
+			/// <returns>Returns true if the cache is open, else false.</returns>
+			bool is_open();
+
+			/// <summary>Set the maximum number of entries to keep.</summary>
+			/// <param name="max_entries">The maximum number of entries, one per file and algorithm. The
+			/// default is 1,000,000.</param>
+			/// <remarks>When the cache grows past this limit the least recently used entries are
+			/// removed.</remarks>
+			void set_max_entries(unsigned int max_entries);
+
+			/// <summary>Compact the cache.</summary>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			/// <remarks>Removes the entries of files that no longer exist or have changed, trims the
+			/// cache to the maximum number of entries and then returns the freed space to the file
+			/// system. Every file in the cache is checked, so call this occasionally, e.g. at startup
+			/// or when idle, rather than before every scan.</remarks>
+			bool compact(std::string& error);
+
+			/// <summary>Remove all the entries in the cache.</summary>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if successful, else false.</returns>
+			bool clear(std::string& error);
+
+		private:
+			class impl;
+			impl& _d;
+
+			// what identifies the contents of a file without reading it
+			struct file_stamp {
+				std::string path;
+				unsigned long long size = 0;
+				unsigned long long modified = 0;
+				std::string file_id;
+			};
+
+			friend class file_hasher;
+
+			// get the stamp of a file; returns false if the cache is not open or the file cannot be opened
+			bool get_stamp(const std::string& fullpath, file_stamp& stamp);
+
+			// get the cached hashes of a file; returns false unless there is a valid entry for every one
+			// of the algorithms
+			bool lookup(const file_stamp& stamp,
+				const std::vector<hash_file::algorithm>& algorithms,
+				hash_file::hash_results& results);
+
+			// store the hashes of a file, provided it has not changed since its stamp was taken
+			void store(const file_stamp& stamp,
+				const hash_file::hash_results& results);
+
+			// Default constructor and copying an object of this class are not allowed
+			hash_cache() = delete;
+			hash_cache(const hash_cache&) = delete;
+			hash_cache& operator=(const hash_cache&) = delete;
+		};
+
+		/// <summary>Incremental hashing class. Use this to hash data that arrives in chunks, e.g.
+		/// from a network or database stream, without first assembling all of it in memory.</summary>
+		/// <remarks>An object can be reused for any number of hashes; neither <see cref="finalize"></see>
+		/// nor <see cref="reset"></see> reallocate the hashing state.</remarks>
+		class leccore_api hasher {
+		public:
+			/// <summary>Constructor.</summary>
+			/// <param name="algo">The hashing algorithm, as defined in
+			/// <see cref="hash_file::algorithm"></see>.</param>
+			/// <remarks>Throws std::invalid_argument if the algorithm is not one of those defined.</remarks>
+			hasher(hash_file::algorithm algo);
+			~hasher();
+
+			/// <summary>Add data to the hash.</summary>
+			/// <param name="data">A pointer to the data.</param>
+			/// <param name="length">The length of the data, in bytes.</param>
+			void update(const void* data, size_t length);
+
+			/// <summary>Finish hashing.</summary>
+			/// <returns>The hash of all the data added since construction or since the last call to
+			/// <see cref="finalize"></see> or <see cref="reset"></see>.</returns>
+			/// <remarks>The object is reset, ready for the next hash.</remarks>
+			[[nodiscard]]
+			std::string finalize();
+
+			/// <summary>Finish hashing, writing the raw digest.</summary>
+			/// <param name="digest">A buffer of at least <see cref="digest_size"></see> bytes that
+			/// receives the digest.</param>
+			/// <remarks>The object is reset, ready for the next hash. Nothing is allocated.</remarks>
+			void finalize(unsigned char* digest);
+
+			/// <summary>Get the size of the raw digest.</summary>
+			/// <returns>The size of the digest, in bytes, e.g. 32 for SHA256.</returns>
+			unsigned int digest_size();
+
+			/// <summary>Discard the data added so far and start a new hash.</summary>
+			void reset();
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Default constructor and copying an object of this class are not allowed
+			hasher() = delete;
+			hasher(const hasher&) = delete;
+			hasher& operator=(const hasher&) = delete;
+		};
+
+		/// <summary>Batch file hashing class. Hashes many files, e.g. an entire directory tree, on a
+		/// bounded number of workers and streams back the result of each file as soon as it is ready.</summary>
+		/// <remarks>Several files are hashed at the same time, so reading one file overlaps with hashing
+		/// the others.</remarks>
+		class leccore_api hash_batch {
+		public:
+			hash_batch();
+			~hash_batch();
+
+			/// <summary>The result of hashing a single file.</summary>
+			using file_result = struct {
+				/// <summary>The full path to the file.</summary>
+				std::string fullpath;
+
+				/// <summary>Whether the file was hashed successfully.</summary>
+				bool success;
+
+				/// <summary>Error information, if <see cref="success"></see> is false.</summary>
+				std::string error;
+
+				/// <summary>The size of the file, in bytes.</summary>
+				unsigned long long size;
+
+				/// <summary>The hashes, as defined in the <see cref="hash_file::hash_results"></see> type.</summary>
+				hash_file::hash_results hashes;
+			};
+
+			/// <summary>Aggregate progress of the batch.</summary>
+			using batch_progress = struct {
+				/// <summary>The number of files found so far. When hashing a directory this keeps
+				/// growing until the whole directory tree has been listed.</summary>
+				unsigned long long files_total;
+
+				/// <summary>The number of files processed so far, including the ones that failed.</summary>
+				unsigned long long files_done;
+
+				/// <summary>The number of files that could not be hashed.</summary>
+				unsigned long long files_failed;
+
+				/// <summary>The number of bytes hashed so far.</summary>
+				unsigned long long bytes_hashed;
+
+				/// <summary>The time elapsed since the batch was started, in seconds.</summary>
+				double seconds;
+
+				/// <summary>The aggregate hashing throughput, in bytes per second.</summary>
+				double throughput;
+			};
+
+			/// <summary>Start hashing a list of files.</summary>
+			/// <param name="fullpaths">The full paths to the files.</param>
+			/// <param name="algorithms">The list of algorithms to use for every file.</param>
+			/// <param name="workers">The maximum number of files to hash at the same time. Use 0 for one
+			/// per logical processor.</param>
+			/// <remarks>This method returns almost immediately. The hashing is executed on the default
+			/// executor. Use <see cref="on_file_hashed"></see> or <see cref="results"></see> to collect the
+			/// results of the individual files.</remarks>
+			void start(const std::vector<std::string>& fullpaths,
+				const std::vector<hash_file::algorithm>& algorithms,
+				unsigned int workers = 0);
+
+			/// <summary>Start hashing all the files in a directory.</summary>
+			/// <param name="directory">The full path to the directory.</param>
+			/// <param name="recursive">Whether to include the files in the subdirectories.</param>
+			/// <param name="algorithms">The list of algorithms to use for every file.</param>
+			/// <param name="workers">The maximum number of files to hash at the same time. Use 0 for one
+			/// per logical processor.</param>
+			/// <remarks>Hashing begins while the directory is still being listed.</remarks>
+			void start(const std::string& directory,
+				bool recursive,
+				const std::vector<hash_file::algorithm>& algorithms,
+				unsigned int workers = 0);
+
+			/// <summary>Check whether hashing is still in progress.</summary>
+			/// <returns>Returns true if the batch is still underway, else false.</returns>
+			bool hashing();
+
+			/// <summary>Check whether hashing is still in progress.</summary>
+			/// <param name="progress">The aggregate progress, as defined in the
+			/// <see cref="batch_progress"></see> type.</param>
+			/// <returns>Returns true if the batch is still underway, else false.</returns>
+			bool hashing(batch_progress& progress);
+
+			/// <summary>Set a function to be called each time a file has been processed.</summary>
+			/// <param name="callback">The function to call. It is called on the worker that hashed the file,
+			/// and may be called from several workers at the same time.</param>
+			/// <remarks>Set the callback before calling <see cref="start"></see>. When a callback is set the
+			/// results are not queued for <see cref="results"></see>.</remarks>
+			void on_file_hashed(std::function<void(const file_result&)> callback);
+
+			/// <summary>Set how the file data is read.</summary>
+			/// <param name="mode">The read mode, as defined in <see cref="hash_file::read_mode"></see>.</param>
+			/// <remarks>Set the read mode before calling <see cref="start"></see>.</remarks>
+			void set_read_mode(hash_file::read_mode mode);
+
+			/// <summary>Set how the hashes are returned.</summary>
+			/// <param name="format">The format, as defined in <see cref="hash_file::digest_format"></see>.
+			/// </param>
+			/// <remarks>Set the format before calling <see cref="start"></see>.</remarks>
+			void set_digest_format(hash_file::digest_format format);
+
+			/// <summary>Set a persistent cache to consult before reading each file.</summary>
+			/// <param name="p_cache">A pointer to an open <see cref="hash_cache"></see>, or nullptr to
+			/// stop using one. The cache must outlive the batch.</param>
+			/// <remarks>Unchanged files are not read; their hashes are taken from the cache. Set the
+			/// cache before calling <see cref="start"></see>.</remarks>
+			void set_cache(hash_cache* p_cache);
+
+			/// <summary>Collect the results of the files processed since the last call.</summary>
+			/// <param name="results">The results, as defined in the <see cref="file_result"></see> type.
+			/// They are appended to the list.</param>
+			/// <returns>The number of results appended.</returns>
+			/// <remarks>Call this periodically while hashing a large batch to keep memory bounded.</remarks>
+			size_t results(std::vector<file_result>& results);
+
+			/// <summary>Get the overall result of the batch.</summary>
+			/// <param name="error">Error information.</param>
+			/// <returns>Returns true if every file was processed, else false. Files that could not be hashed
+			/// do not make the batch fail; check each file's <see cref="file_result"></see> instead.</returns>
+			bool result(std::string& error);
+
+			/// <summary>Set a function to be called when the whole batch completes.</summary>
+			/// <param name="callback">The function to call. It is called on a worker thread after the last
+			/// file has been processed, so it can call <see cref="result"></see>.</param>
+			void on_complete(std::function<void()> callback);
+
+			/// <summary>Wait for the batch to complete.</summary>
+			/// <param name="timeout_milliseconds">The maximum time to wait, in milliseconds.</param>
+			/// <returns>Returns true if the batch is complete, else false if the timeout elapsed first.</returns>
+			bool wait(unsigned long long timeout_milliseconds);
+
+			/// <summary>Get the completion event.</summary>
+			/// <returns>A handle to a manual-reset Win32 event object (HANDLE) that is signaled when the
+			/// batch completes. It is reset by <see cref="start"></see> and <see cref="result"></see>.</returns>
+			void* completion_event();
+
+			/// <summary>Cancel the batch.</summary>
+			/// <remarks>This method returns immediately. The files being hashed stop at their next chunk, the
+			/// remaining files are skipped and <see cref="result"></see> returns false with the error
+			/// "Operation cancelled".</remarks>
+			void cancel();
+
+			/// <summary>Set a cancellation token to observe in addition to <see cref="cancel"></see>.</summary>
+			/// <param name="token">The token, as defined in <see cref="cancellation_token"></see>.</param>
+			/// <remarks>The token applies to batches started after this call.</remarks>
+			void set_cancellation_token(const cancellation_token& token);
+
+		private:
+			class impl;
+			impl& _d;
+
+			// Copying an object of this class is not allowed
+			hash_batch(const hash_batch&) = delete;
+			hash_batch& operator=(const hash_batch&) = delete;
+		};
 	}
 }
@@ -0,0 +1,566 @@
+//
+// blake3.cpp - BLAKE3 hash implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "blake3.h"
+#include "../executor/parallel_for.h"
+#include <cpu.h>
+
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define LECCORE_BLAKE3_SIMD
+#endif
+
+using namespace liblec::leccore;
+
+namespace {
+	const uint32_t _iv[8] = {
+		0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+		0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+	};
+
+	enum : uint8_t {
+		chunk_start = 1 << 0,
+		chunk_end = 1 << 1,
+		parent = 1 << 2,
+		root = 1 << 3,
+	};
+
+	// the order in which each of the 7 rounds uses the message words
+	const uint8_t _schedule[7][16] = {
+		{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+		{ 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+		{ 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+		{ 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+		{ 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+		{ 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+		{ 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 },
+	};
+
+	// subtrees of at most this many chunks are hashed on a single thread
+	const size_t _piece_chunks = 64;
+
+	inline uint32_t load32(const uint8_t* p) {
+		uint32_t x;
+		memcpy(&x, p, sizeof(x));	// Windows targets are all little endian
+		return x;
+	}
+
+	inline void store32(uint8_t* p, uint32_t x) {
+		memcpy(p, &x, sizeof(x));
+	}
+
+	inline uint32_t rotr(uint32_t x, int n) {
+		return (x >> n) | (x << (32 - n));
+	}
+
+	inline void g(uint32_t* v, int a, int b, int c, int d, uint32_t x, uint32_t y) {
+		v[a] = v[a] + v[b] + x;
+		v[d] = rotr(v[d] ^ v[a], 16);
+		v[c] = v[c] + v[d];
+		v[b] = rotr(v[b] ^ v[c], 12);
+		v[a] = v[a] + v[b] + y;
+		v[d] = rotr(v[d] ^ v[a], 8);
+		v[c] = v[c] + v[d];
+		v[b] = rotr(v[b] ^ v[c], 7);
+	}
+
+	void compress(const uint32_t cv[8], const uint8_t block[64], uint8_t block_length,
+		uint64_t counter, uint8_t flags, uint32_t out[16]) {
+		uint32_t m[16];
+		for (int i = 0; i < 16; i++)
+			m[i] = load32(block + 4 * i);
+
+		uint32_t v[16] = {
+			cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+			_iv[0], _iv[1], _iv[2], _iv[3],
+			static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32),
+			block_length, flags
+		};
+
+		for (const auto& s : _schedule) {
+			g(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+			g(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+			g(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+			g(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+			g(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+			g(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+			g(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+			g(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+		}
+
+		for (int i = 0; i < 8; i++) {
+			out[i] = v[i] ^ v[i + 8];
+			out[i + 8] = v[i + 8] ^ cv[i];
+		}
+	}
+
+	void compress_in_place(uint32_t cv[8], const uint8_t block[64], uint8_t block_length,
+		uint64_t counter, uint8_t flags) {
+		uint32_t out[16];
+		compress(cv, block, block_length, counter, flags, out);
+		memcpy(cv, out, 8 * sizeof(uint32_t));
+	}
+
+	// the input of the last compression of a node, which is only known once the node is complete;
+	// compressing it gives either the node's chaining value or, for the root, the output
+	struct output {
+		uint32_t cv[8];
+		uint8_t block[64];
+		uint8_t block_length;
+		uint64_t counter;
+		uint8_t flags;
+	};
+
+	output make_output(const uint32_t cv[8], const uint8_t block[64], uint8_t block_length,
+		uint64_t counter, uint8_t flags) {
+		output o;
+		memcpy(o.cv, cv, sizeof(o.cv));
+		memcpy(o.block, block, sizeof(o.block));
+		o.block_length = block_length;
+		o.counter = counter;
+		o.flags = flags;
+		return o;
+	}
+
+	output parent_output(const uint8_t block[64]) {
+		return make_output(_iv, block, 64, 0, parent);
+	}
+
+	void chaining_value(const output& o, uint8_t cv[32]) {
+		uint32_t out[16];
+		compress(o.cv, o.block, o.block_length, o.counter, o.flags, out);
+
+		for (int i = 0; i < 8; i++)
+			store32(cv + 4 * i, out[i]);
+	}
+
+	void root_bytes(const output& o, uint8_t* digest, size_t length) {
+		uint64_t counter = 0;
+		uint8_t block[64];
+
+		while (length > 0) {
+			uint32_t out[16];
+			compress(o.cv, o.block, o.block_length, counter++, o.flags | root, out);
+
+			for (int i = 0; i < 16; i++)
+				store32(block + 4 * i, out[i]);
+
+			const size_t take = (std::min)(length, sizeof(block));
+			memcpy(digest, block, take);
+			digest += take;
+			length -= take;
+		}
+	}
+
+#if defined(LECCORE_BLAKE3_SIMD)
+	// hash one input per lane, each lane being a 32 bit element of a vector
+	struct sse2 {
+		using vec = __m128i;
+		static const size_t lanes = 4;
+
+		static vec add(vec a, vec b) { return _mm_add_epi32(a, b); }
+		static vec xor_(vec a, vec b) { return _mm_xor_si128(a, b); }
+		static vec set1(uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+		static vec load(const uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const vec*>(p)); }
+		static void store(uint32_t* p, vec x) { _mm_storeu_si128(reinterpret_cast<vec*>(p), x); }
+
+		template <int n>
+		static vec rotr(vec x) { return _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - n)); }
+	};
+
+	struct avx2 {
+		using vec = __m256i;
+		static const size_t lanes = 8;
+
+		static vec add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+		static vec xor_(vec a, vec b) { return _mm256_xor_si256(a, b); }
+		static vec set1(uint32_t x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+		static vec load(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const vec*>(p)); }
+		static void store(uint32_t* p, vec x) { _mm256_storeu_si256(reinterpret_cast<vec*>(p), x); }
+
+		template <int n>
+		static vec rotr(vec x) { return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n)); }
+	};
+
+	template <typename simd>
+	inline void g(typename simd::vec* v, int a, int b, int c, int d,
+		typename simd::vec x, typename simd::vec y) {
+		v[a] = simd::add(simd::add(v[a], v[b]), x);
+		v[d] = simd::template rotr<16>(simd::xor_(v[d], v[a]));
+		v[c] = simd::add(v[c], v[d]);
+		v[b] = simd::template rotr<12>(simd::xor_(v[b], v[c]));
+		v[a] = simd::add(simd::add(v[a], v[b]), y);
+		v[d] = simd::template rotr<8>(simd::xor_(v[d], v[a]));
+		v[c] = simd::add(v[c], v[d]);
+		v[b] = simd::template rotr<7>(simd::xor_(v[b], v[c]));
+	}
+
+	template <typename simd>
+	void hash_lanes(const uint8_t* const* inputs, size_t blocks, uint64_t counter,
+		bool increment_counter, uint8_t flags, uint8_t flags_start, uint8_t flags_end, uint8_t* out) {
+		using vec = typename simd::vec;
+		uint32_t words[simd::lanes];
+
+		vec h[8];
+		for (int i = 0; i < 8; i++)
+			h[i] = simd::set1(_iv[i]);
+
+		for (size_t lane = 0; lane < simd::lanes; lane++)
+			words[lane] = static_cast<uint32_t>(counter + (increment_counter ? lane : 0));
+		const vec counter_low = simd::load(words);
+
+		for (size_t lane = 0; lane < simd::lanes; lane++)
+			words[lane] = static_cast<uint32_t>((counter + (increment_counter ? lane : 0)) >> 32);
+		const vec counter_high = simd::load(words);
+
+		uint8_t block_flags = flags | flags_start;
+
+		for (size_t block = 0; block < blocks; block++) {
+			if (block + 1 == blocks)
+				block_flags |= flags_end;
+
+			vec m[16];
+			for (int i = 0; i < 16; i++) {
+				for (size_t lane = 0; lane < simd::lanes; lane++)
+					words[lane] = load32(inputs[lane] + 64 * block + 4 * i);
+
+				m[i] = simd::load(words);
+			}
+
+			vec v[16] = {
+				h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+				simd::set1(_iv[0]), simd::set1(_iv[1]), simd::set1(_iv[2]), simd::set1(_iv[3]),
+				counter_low, counter_high, simd::set1(64), simd::set1(block_flags)
+			};
+
+			for (const auto& s : _schedule) {
+				g<simd>(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+				g<simd>(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+				g<simd>(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+				g<simd>(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+				g<simd>(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+				g<simd>(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+				g<simd>(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+				g<simd>(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+			}
+
+			for (int i = 0; i < 8; i++)
+				h[i] = simd::xor_(v[i], v[i + 8]);
+
+			block_flags = flags;
+		}
+
+		for (int i = 0; i < 8; i++) {
+			simd::store(words, h[i]);
+
+			for (size_t lane = 0; lane < simd::lanes; lane++)
+				store32(out + 32 * lane + 4 * i, words[lane]);
+		}
+	}
+#endif
+
+	// Hash inputs of blocks * 64 bytes each, which are all whole chunks or all parent nodes, and
+	// write a 32 byte chaining value for each. The outputs may overwrite the inputs, as long as
+	// the n-th output is no further into the buffer than the n-th input.
+	void hash_many(const uint8_t* const* inputs, size_t count, size_t blocks, uint64_t counter,
+		bool increment_counter, uint8_t flags, uint8_t flags_start, uint8_t flags_end, uint8_t* out) {
+#if defined(LECCORE_BLAKE3_SIMD)
+		static const bool has_avx2 = CryptoPP::HasAVX2();
+
+		if (has_avx2) {
+			for (; count >= avx2::lanes; count -= avx2::lanes) {
+				hash_lanes<avx2>(inputs, blocks, counter, increment_counter,
+					flags, flags_start, flags_end, out);
+
+				inputs += avx2::lanes;
+				out += 32 * avx2::lanes;
+				if (increment_counter)
+					counter += avx2::lanes;
+			}
+		}
+
+		for (; count >= sse2::lanes; count -= sse2::lanes) {
+			hash_lanes<sse2>(inputs, blocks, counter, increment_counter,
+				flags, flags_start, flags_end, out);
+
+			inputs += sse2::lanes;
+			out += 32 * sse2::lanes;
+			if (increment_counter)
+				counter += sse2::lanes;
+		}
+#endif
+
+		for (; count > 0; count--) {
+			uint32_t cv[8];
+			memcpy(cv, _iv, sizeof(cv));
+
+			uint8_t block_flags = flags | flags_start;
+
+			for (size_t block = 0; block < blocks; block++) {
+				if (block + 1 == blocks)
+					block_flags |= flags_end;
+
+				compress_in_place(cv, *inputs + 64 * block, 64, counter, block_flags);
+				block_flags = flags;
+			}
+
+			for (int i = 0; i < 8; i++)
+				store32(out + 4 * i, cv[i]);
+
+			inputs++;
+			out += 32;
+			if (increment_counter)
+				counter++;
+		}
+	}
+
+	// combine a power of two number of chaining values pairwise, in place, until target are left
+	void reduce(uint8_t* cvs, size_t count, size_t target) {
+		const uint8_t* inputs[_piece_chunks / 2];
+
+		while (count > target) {
+			const size_t parents = count / 2;
+
+			for (size_t done = 0; done < parents; done += _piece_chunks / 2) {
+				const size_t batch = (std::min)(parents - done, _piece_chunks / 2);
+
+				for (size_t i = 0; i < batch; i++)
+					inputs[i] = cvs + 64 * (done + i);
+
+				hash_many(inputs, batch, 1, 0, false, parent, 0, 0, cvs + 32 * done);
+			}
+
+			count = parents;
+		}
+	}
+
+	// chaining value of a complete subtree of a power of two number of chunks that is not the root
+	void subtree_cv(const uint8_t* input, size_t chunks, uint64_t counter, uint8_t cv[32]) {
+		if (chunks > _piece_chunks) {
+			uint8_t children[64];
+			subtree_cv(input, chunks / 2, counter, children);
+			subtree_cv(input + chunks / 2 * blake3_hash::CHUNKSIZE, chunks / 2, counter + chunks / 2,
+				children + 32);
+			chaining_value(parent_output(children), cv);
+			return;
+		}
+
+		const uint8_t* inputs[_piece_chunks];
+		uint8_t cvs[_piece_chunks * 32];
+
+		for (size_t i = 0; i < chunks; i++)
+			inputs[i] = input + i * blake3_hash::CHUNKSIZE;
+
+		hash_many(inputs, chunks, blake3_hash::CHUNKSIZE / 64, counter, true,
+			0, chunk_start, chunk_end, cvs);
+		reduce(cvs, chunks, 1);
+		memcpy(cv, cvs, 32);
+	}
+
+	// the chaining values of the two children of a complete subtree of a power of two number of
+	// chunks, at least two; the subtree is split into pieces that are hashed in parallel
+	void subtree_children(const uint8_t* input, size_t chunks, uint64_t counter, uint8_t children[64]) {
+		static const size_t max_pieces = 4 * static_cast<size_t>((std::max)(1u,
+			std::thread::hardware_concurrency()));
+
+		size_t pieces = 2;
+		while (pieces * 2 <= chunks / _piece_chunks && pieces * 2 <= max_pieces)
+			pieces *= 2;
+
+		const size_t piece_chunks = chunks / pieces;
+
+		// the heap is only needed on machines with very many processors
+		uint8_t local_cvs[32 * 64];
+		std::vector<uint8_t> heap_cvs;
+		uint8_t* cvs = local_cvs;
+
+		if (pieces > 64) {
+			heap_cvs.resize(32 * pieces);
+			cvs = heap_cvs.data();
+		}
+
+		auto piece = [&](size_t i) {
+			subtree_cv(input + i * piece_chunks * blake3_hash::CHUNKSIZE, piece_chunks,
+				counter + i * piece_chunks, cvs + 32 * i);
+		};
+
+		if (pieces > 2)
+			parallel_for(pieces, piece);
+		else
+			for (size_t i = 0; i < pieces; i++)
+				piece(i);
+
+		reduce(cvs, pieces, 2);
+		memcpy(children, cvs, 64);
+	}
+
+	size_t round_down_to_power_of_2(size_t x) {
+		size_t power = 1;
+		while (power <= x / 2)
+			power *= 2;
+
+		return power;
+	}
+
+	unsigned int popcount(uint64_t x) {
+		unsigned int count = 0;
+		for (; x; x &= x - 1)
+			count++;
+
+		return count;
+	}
+}
+
+blake3_hash::blake3_hash() {
+	Restart();
+}
+
+size_t blake3_hash::chunk_length() const {
+	return BLOCKSIZE * static_cast<size_t>(_blocks_compressed) + _block_length;
+}
+
+void blake3_hash::chunk_update(const uint8_t* input, size_t length) {
+	while (length > 0) {
+		if (_block_length == BLOCKSIZE) {
+			compress_in_place(_cv, _block, BLOCKSIZE, _chunk_counter,
+				_blocks_compressed == 0 ? chunk_start : 0);
+			_blocks_compressed++;
+			_block_length = 0;
+			memset(_block, 0, sizeof(_block));
+		}
+
+		const size_t take = (std::min)(length, static_cast<size_t>(BLOCKSIZE - _block_length));
+		memcpy(_block + _block_length, input, take);
+		_block_length += static_cast<uint8_t>(take);
+		input += take;
+		length -= take;
+	}
+}
+
+void blake3_hash::chunk_reset(uint64_t chunk_counter) {
+	memcpy(_cv, _iv, sizeof(_cv));
+	_chunk_counter = chunk_counter;
+	memset(_block, 0, sizeof(_block));
+	_block_length = 0;
+	_blocks_compressed = 0;
+}
+
+void blake3_hash::merge_cv_stack(uint64_t total_chunks) {
+	// a completed subtree stays on the stack until it is known not to be the root
+	const size_t length = popcount(total_chunks);
+
+	while (_cv_stack_length > length) {
+		uint8_t* p_parent = _cv_stack + 32 * (_cv_stack_length - 2);
+		chaining_value(parent_output(p_parent), p_parent);
+		_cv_stack_length--;
+	}
+}
+
+void blake3_hash::push_cv(const uint8_t cv[32], uint64_t chunk_counter) {
+	merge_cv_stack(chunk_counter);
+	memcpy(_cv_stack + 32 * _cv_stack_length, cv, 32);
+	_cv_stack_length++;
+}
+
+void blake3_hash::Update(const CryptoPP::byte* input, size_t length) {
+	if (length == 0)
+		return;
+
+	// finish the chunk in progress
+	if (chunk_length() > 0) {
+		const size_t take = (std::min)(length, CHUNKSIZE - chunk_length());
+		chunk_update(input, take);
+		input += take;
+		length -= take;
+
+		if (length == 0)
+			return;
+
+		uint8_t cv[32];
+		chaining_value(make_output(_cv, _block, _block_length, _chunk_counter,
+			(_blocks_compressed == 0 ? chunk_start : 0) | chunk_end), cv);
+		push_cv(cv, _chunk_counter);
+		chunk_reset(_chunk_counter + 1);
+	}
+
+	// hash the largest complete subtrees the input allows; the last chunk is kept back because it
+	// may turn out to be the root
+	while (length > CHUNKSIZE) {
+		size_t subtree_length = round_down_to_power_of_2(length);
+		const uint64_t count_so_far = _chunk_counter * CHUNKSIZE;
+
+		// a subtree has to start at a multiple of its size
+		while ((static_cast<uint64_t>(subtree_length - 1) & count_so_far) != 0)
+			subtree_length /= 2;
+
+		const uint64_t subtree_chunks = subtree_length / CHUNKSIZE;
+
+		if (subtree_chunks == 1) {
+			uint8_t cv[32];
+			hash_many(&input, 1, CHUNKSIZE / 64, _chunk_counter, true, 0, chunk_start, chunk_end, cv);
+			push_cv(cv, _chunk_counter);
+		}
+		else {
+			uint8_t children[64];
+			subtree_children(input, static_cast<size_t>(subtree_chunks), _chunk_counter, children);
+			push_cv(children, _chunk_counter);
+			push_cv(children + 32, _chunk_counter + subtree_chunks / 2);
+		}
+
+		_chunk_counter += subtree_chunks;
+		input += subtree_length;
+		length -= subtree_length;
+	}
+
+	if (length > 0) {
+		chunk_update(input, length);
+		merge_cv_stack(_chunk_counter);
+	}
+}
+
+void blake3_hash::TruncatedFinal(CryptoPP::byte* digest, size_t digestSize) {
+	ThrowIfInvalidTruncatedSize(digestSize);
+
+	const uint8_t chunk_flags = (_blocks_compressed == 0 ? chunk_start : 0) | chunk_end;
+	output o = make_output(_cv, _block, _block_length, _chunk_counter, chunk_flags);
+
+	if (_cv_stack_length > 0) {
+		size_t remaining = _cv_stack_length;
+
+		if (chunk_length() == 0) {
+			// the input ended on a chunk boundary, so the last two subtrees on the stack are the
+			// children of the next node up
+			remaining -= 2;
+			o = parent_output(_cv_stack + 32 * remaining);
+		}
+
+		while (remaining > 0) {
+			remaining--;
+
+			uint8_t block[64];
+			memcpy(block, _cv_stack + 32 * remaining, 32);
+			chaining_value(o, block + 32);
+			o = parent_output(block);
+		}
+	}
+
+	root_bytes(o, digest, digestSize);
+	Restart();
+}
+
+void blake3_hash::Restart() {
+	chunk_reset(0);
+	_cv_stack_length = 0;
+}
@@ -0,0 +1,62 @@
+//
+// blake3.h - BLAKE3 hash interface
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include <cryptlib.h>
+#include <cstdint>
+
+namespace liblec {
+	namespace leccore {
+		// BLAKE3 hash with a 256 bit digest, as a Crypto++ hash so it can be used anywhere the other
+		// hashes are, e.g. in a HashFilter.
+		//
+		// BLAKE3 splits its input into 1 KB chunks that are hashed independently and then combined in
+		// a binary tree. Several chunks are hashed at once with SSE2 or AVX2, and large updates are split
+		// into subtrees that are hashed on the default executor, so a single large file is hashed on
+		// all the processors.
+		class blake3_hash : public CryptoPP::HashTransformation {
+		public:
+			static const unsigned int DIGESTSIZE = 32;
+			static const unsigned int BLOCKSIZE = 64;
+			static const unsigned int CHUNKSIZE = 1024;
+
+			blake3_hash();
+
+			std::string AlgorithmName() const override { return "BLAKE3"; }
+			unsigned int DigestSize() const override { return DIGESTSIZE; }
+			unsigned int BlockSize() const override { return BLOCKSIZE; }
+			unsigned int OptimalBlockSize() const override { return CHUNKSIZE; }
+
+			void Update(const CryptoPP::byte* input, size_t length) override;
+			void TruncatedFinal(CryptoPP::byte* digest, size_t digestSize) override;
+			void Restart() override;
+
+		private:
+			// the chunk currently being filled
+			uint32_t _cv[8];
+			uint64_t _chunk_counter;
+			uint8_t _block[BLOCKSIZE];
+			uint8_t _block_length;
+			uint8_t _blocks_compressed;
+
+			// chaining values of completed subtrees, at most one per bit of the chunk counter
+			uint8_t _cv_stack[54 * 32];
+			uint8_t _cv_stack_length;
+
+			size_t chunk_length() const;
+			void chunk_update(const uint8_t* input, size_t length);
+			void chunk_reset(uint64_t chunk_counter);
+
+			void merge_cv_stack(uint64_t total_chunks);
+			void push_cv(const uint8_t cv[32], uint64_t chunk_counter);
+		};
+	}
+}
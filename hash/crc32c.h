@@ -0,0 +1,50 @@
+//
+// crc32c.h - CRC32C checksum interface
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include <cryptlib.h>
+#include <crc.h>
+
+namespace liblec {
+	namespace leccore {
+		// CRC32C (Castagnoli) checksum. The computation is Crypto++'s, which uses the SSE4.2 crc32
+		// instruction where available. Crypto++ writes the checksum least significant byte first;
+		// this class writes it most significant byte first instead, so its hex form reads the same as
+		// the number, e.g. e3069283 for "123456789", like other CRC tools.
+		class crc32c_hash : public CryptoPP::HashTransformation {
+			CryptoPP::CRC32C _crc;
+
+		public:
+			static const unsigned int DIGESTSIZE = 4;
+
+			std::string AlgorithmName() const override { return "CRC32C"; }
+			unsigned int DigestSize() const override { return DIGESTSIZE; }
+
+			void Update(const CryptoPP::byte* input, size_t length) override {
+				_crc.Update(input, length);
+			}
+
+			void TruncatedFinal(CryptoPP::byte* digest, size_t digestSize) override {
+				ThrowIfInvalidTruncatedSize(digestSize);
+
+				CryptoPP::byte crc[DIGESTSIZE];
+				_crc.Final(crc);
+
+				for (size_t i = 0; i < digestSize; i++)
+					digest[i] = crc[DIGESTSIZE - 1 - i];
+			}
+
+			void Restart() override {
+				_crc.Restart();
+			}
+		};
+	}
+}
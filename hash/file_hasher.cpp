@@ -0,0 +1,456 @@
+//
+// file_hasher.cpp - single sweep file hashing implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "file_hasher.h"
+#include "../encode.h"
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <Windows.h>
+
+using namespace liblec::leccore;
+
+// size of the chunks files are hashed in; cancellation is checked between chunks
+static const size_t _chunk_size = 1024 * 1024;
+
+// size of the views mapped files are hashed through; a multiple of the allocation granularity
+static const unsigned long long _view_size = 64 * 1024 * 1024;
+
+// size of the blocks of direct reads; a multiple of any sector size
+static const DWORD _block_size = 4 * 1024 * 1024;
+
+// files up to this size are mapped in automatic mode, larger ones are read directly
+static const unsigned long long _mapped_limit = 256 * 1024 * 1024;
+
+// files are opened the way the file streams open them, so files that other processes have open,
+// even for writing, e.g. logs and downloads in progress, can still be hashed
+static const DWORD _share_mode = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+
+namespace {
+	// closes a Win32 handle when going out of scope
+	class handle_guard {
+		HANDLE _handle;
+
+	public:
+		handle_guard(HANDLE handle) :
+			_handle(handle) {}
+		~handle_guard() {
+			if (_handle && _handle != INVALID_HANDLE_VALUE)
+				CloseHandle(_handle);
+		}
+
+		HANDLE get() const { return _handle; }
+		bool valid() const { return _handle && _handle != INVALID_HANDLE_VALUE; }
+	};
+}
+
+file_hasher::file_hasher(const std::vector<hash_file::algorithm>& algorithms,
+	hash_file::read_mode mode,
+	hash_cache* p_cache,
+	hash_file::digest_format format) :
+	_mode(mode),
+	_format(format),
+	_p_cache(p_cache),
+	_p_aligned(nullptr),
+	_parallel(false) {
+	for (const auto& algo : algorithms) {
+		bool added = false;
+		for (const auto& it : _hashers)
+			if (it.first == algo)
+				added = true;
+
+		if (!added) {
+			_hashers.emplace_back(algo, std::make_unique<hasher>(algo));
+			_algorithms.push_back(algo);
+
+			// BLAKE3 hashes large inputs on several threads at once
+			if (algo == hash_file::algorithm::blake3)
+				_parallel = true;
+		}
+	}
+}
+
+file_hasher::~file_hasher() {
+	if (_p_aligned)
+		VirtualFree(_p_aligned, 0, MEM_RELEASE);
+}
+
+void file_hasher::feed(const char* data, size_t size) {
+	for (auto& it : _hashers)
+		it.second->update(data, size);
+}
+
+bool file_hasher::feed_mapped(const char* data, size_t size) {
+	// Hashers that spread their work over the executor's threads must never read mapped memory:
+	// the handler below only covers this thread, and an in-page error on any other thread would
+	// end the process. They are given a copy of the data in the read buffer instead.
+	if (_parallel && _buffer.size() < size)
+		_buffer.resize(size);
+
+	// a failure to page in mapped data, e.g. a disk error or a network file going away,
+	// is raised as a structured exception rather than returned as an error
+	__try {
+		if (_parallel)
+			memcpy(_buffer.data(), data, size);
+		else
+			feed(data, size);
+	}
+	__except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ?
+		EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH) {
+		return false;
+	}
+
+	if (_parallel)
+		feed(_buffer.data(), size);
+
+	return true;
+}
+
+bool file_hasher::read_buffered(const std::string& fullpath,
+	const std::function<bool()>& cancelled,
+	unsigned long long& size,
+	std::string& error) {
+	std::ifstream file(fullpath, std::ios::binary);
+
+	if (!file.is_open()) {
+		error = "Error opening file";
+		return false;
+	}
+
+	if (_buffer.empty())
+		_buffer.resize(_chunk_size);
+
+	// feed the file to every hasher in chunks, checking for cancellation in between
+	while (file) {
+		if (cancelled()) {
+			error = "Operation cancelled";
+			return false;
+		}
+
+		file.read(_buffer.data(), _buffer.size());
+		const auto read = file.gcount();
+
+		if (read > 0) {
+			feed(_buffer.data(), static_cast<size_t>(read));
+			size += static_cast<unsigned long long>(read);
+		}
+	}
+
+	if (file.bad()) {
+		error = "Error reading file";
+		return false;
+	}
+
+	return true;
+}
+
+bool file_hasher::read_mapped(const std::string& fullpath,
+	const std::function<bool()>& cancelled,
+	unsigned long long& size,
+	std::string& error) {
+	handle_guard file(CreateFileA(fullpath.c_str(), GENERIC_READ, _share_mode, nullptr,
+		OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr));
+
+	if (!file.valid()) {
+		error = "Error opening file";
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file.get(), &file_size)) {
+		error = "Error reading file";
+		return false;
+	}
+
+	// empty files cannot be mapped
+	if (file_size.QuadPart == 0)
+		return true;
+
+	handle_guard mapping(CreateFileMappingA(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+
+	if (!mapping.valid()) {
+		error = "Error mapping file";
+		return false;
+	}
+
+	const unsigned long long total = static_cast<unsigned long long>(file_size.QuadPart);
+
+	for (unsigned long long offset = 0; offset < total; offset += _view_size) {
+		const size_t view_size = static_cast<size_t>((std::min)(_view_size, total - offset));
+
+		const char* p_view = static_cast<const char*>(MapViewOfFile(mapping.get(), FILE_MAP_READ,
+			static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset), view_size));
+
+		if (!p_view) {
+			error = "Error mapping file";
+			return false;
+		}
+
+		for (size_t position = 0; position < view_size; position += _chunk_size) {
+			if (cancelled()) {
+				UnmapViewOfFile(p_view);
+				error = "Operation cancelled";
+				return false;
+			}
+
+			const size_t chunk_size = (std::min)(_chunk_size, view_size - position);
+
+			if (!feed_mapped(p_view + position, chunk_size)) {
+				UnmapViewOfFile(p_view);
+				error = "Error reading file";
+				return false;
+			}
+
+			size += chunk_size;
+		}
+
+		UnmapViewOfFile(p_view);
+	}
+
+	return true;
+}
+
+bool file_hasher::read_direct(const std::string& fullpath,
+	const std::function<bool()>& cancelled,
+	unsigned long long& size,
+	std::string& error) {
+	const DWORD flags = FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN;
+
+	HANDLE handle = CreateFileA(fullpath.c_str(), GENERIC_READ, _share_mode, nullptr,
+		OPEN_EXISTING, flags | FILE_FLAG_NO_BUFFERING, nullptr);
+
+	if (handle == INVALID_HANDLE_VALUE && GetLastError() == ERROR_INVALID_PARAMETER) {
+		// the volume does not support unbuffered reads; go through the file cache instead
+		handle = CreateFileA(fullpath.c_str(), GENERIC_READ, _share_mode, nullptr,
+			OPEN_EXISTING, flags, nullptr);
+	}
+
+	handle_guard file(handle);
+
+	if (!file.valid()) {
+		error = "Error opening file";
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file.get(), &file_size)) {
+		error = "Error reading file";
+		return false;
+	}
+
+	if (!_p_aligned) {
+		// page aligned, which satisfies the sector alignment unbuffered reads require
+		_p_aligned = VirtualAlloc(nullptr, 2 * static_cast<SIZE_T>(_block_size),
+			MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+
+		if (!_p_aligned) {
+			error = "Error allocating read buffer";
+			return false;
+		}
+	}
+
+	handle_guard event_0(CreateEventA(nullptr, TRUE, FALSE, nullptr));
+	handle_guard event_1(CreateEventA(nullptr, TRUE, FALSE, nullptr));
+
+	if (!event_0.valid() || !event_1.valid()) {
+		error = "Error reading file";
+		return false;
+	}
+
+	// two blocks: one is being read by the system while the other is being hashed
+	struct block {
+		OVERLAPPED overlapped;
+		char* data;
+		bool pending;
+	};
+
+	block blocks[2];
+	blocks[0] = { {}, static_cast<char*>(_p_aligned), false };
+	blocks[1] = { {}, static_cast<char*>(_p_aligned) + _block_size, false };
+	blocks[0].overlapped.hEvent = event_0.get();
+	blocks[1].overlapped.hEvent = event_1.get();
+
+	const unsigned long long total = static_cast<unsigned long long>(file_size.QuadPart);
+
+	auto issue = [&file](block& b, unsigned long long offset) {
+		HANDLE event = b.overlapped.hEvent;
+		b.overlapped = {};
+		b.overlapped.Offset = static_cast<DWORD>(offset);
+		b.overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+		b.overlapped.hEvent = event;
+
+		if (!ReadFile(file.get(), b.data, _block_size, nullptr, &b.overlapped) &&
+			GetLastError() != ERROR_IO_PENDING)
+			return false;
+
+		b.pending = true;
+		return true;
+	};
+
+	auto complete = [&file](block& b, DWORD& read) {
+		b.pending = false;
+		read = 0;
+
+		if (!GetOverlappedResult(file.get(), &b.overlapped, &read, TRUE))
+			return GetLastError() == ERROR_HANDLE_EOF;
+
+		return true;
+	};
+
+	// the buffers must not be released while the system may still be writing to them
+	auto abandon = [&file, &blocks]() {
+		for (auto& b : blocks) {
+			if (b.pending) {
+				DWORD read = 0;
+				CancelIoEx(file.get(), &b.overlapped);
+				GetOverlappedResult(file.get(), &b.overlapped, &read, TRUE);
+				b.pending = false;
+			}
+		}
+	};
+
+	unsigned long long offset = 0;
+	size_t current = 0;
+
+	if (total > 0) {
+		if (!issue(blocks[current], offset)) {
+			error = "Error reading file";
+			return false;
+		}
+
+		offset += _block_size;
+	}
+
+	while (blocks[current].pending) {
+		DWORD read = 0;
+		if (!complete(blocks[current], read)) {
+			abandon();
+			error = "Error reading file";
+			return false;
+		}
+
+		// start reading the next block before hashing this one
+		block& next = blocks[1 - current];
+		if (offset < total) {
+			if (!issue(next, offset)) {
+				abandon();
+				error = "Error reading file";
+				return false;
+			}
+
+			offset += _block_size;
+		}
+
+		for (DWORD position = 0; position < read; position += static_cast<DWORD>(_chunk_size)) {
+			if (cancelled()) {
+				abandon();
+				error = "Operation cancelled";
+				return false;
+			}
+
+			const size_t chunk_size = (std::min)(_chunk_size, static_cast<size_t>(read - position));
+			feed(blocks[current].data + position, chunk_size);
+			size += chunk_size;
+		}
+
+		current = 1 - current;
+	}
+
+	return true;
+}
+
+bool file_hasher::hash(const std::string& fullpath,
+	const std::function<bool()>& cancelled,
+	hash_file::hash_results& results,
+	unsigned long long& size,
+	std::string& error) {
+	error.clear();
+	results.clear();
+	size = 0;
+
+	// the stamp is taken before the file is read, so hashes of a file that changes while it is
+	// being read are not cached
+	hash_cache::file_stamp stamp;
+	const bool stamped = _p_cache && _p_cache->get_stamp(fullpath, stamp);
+
+	if (stamped && _p_cache->lookup(stamp, _algorithms, results)) {
+		// the cache holds hex
+		if (_format == hash_file::digest_format::raw)
+			for (auto& it : results)
+				it.second = base16::decode(it.second);
+
+		size = stamp.size;
+		return true;
+	}
+
+	for (auto& it : _hashers)
+		it.second->reset();
+
+	hash_file::read_mode mode = _mode;
+
+	if (mode == hash_file::read_mode::automatic) {
+		std::error_code code;
+		const auto file_size = std::filesystem::file_size(fullpath, code);
+
+		if (code)
+			mode = hash_file::read_mode::buffered;	// let the read report the error
+		else
+			mode = file_size <= _mapped_limit ?
+			hash_file::read_mode::mapped : hash_file::read_mode::direct;
+	}
+
+	bool success = false;
+
+	switch (mode) {
+	case hash_file::read_mode::mapped:
+		success = read_mapped(fullpath, cancelled, size, error);
+		break;
+
+	case hash_file::read_mode::direct:
+		success = read_direct(fullpath, cancelled, size, error);
+		break;
+
+	case hash_file::read_mode::buffered:
+	default:
+		success = read_buffered(fullpath, cancelled, size, error);
+		break;
+	}
+
+	if (!success)
+		return false;
+
+	if (_format == hash_file::digest_format::raw) {
+		for (auto& it : _hashers) {
+			std::string digest(it.second->digest_size(), '\0');
+			it.second->finalize(reinterpret_cast<unsigned char*>(&digest[0]));
+			results[it.first] = std::move(digest);
+		}
+
+		if (stamped) {
+			// the cache holds hex
+			hash_file::hash_results hex;
+			for (const auto& it : results)
+				hex[it.first] = base16::encode(it.second);
+
+			_p_cache->store(stamp, hex);
+		}
+
+		return true;
+	}
+
+	for (auto& it : _hashers)
+		results[it.first] = it.second->finalize();
+
+	if (stamped)
+		_p_cache->store(stamp, results);
+
+	return true;
+}
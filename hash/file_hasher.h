@@ -0,0 +1,79 @@
+//
+// file_hasher.h - single sweep file hashing interface
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include "../hash.h"
+#include <functional>
+#include <memory>
+
+namespace liblec {
+	namespace leccore {
+		// Hashes files with several algorithms in a single sweep. The hashers and the read buffers
+		// are reused from one file to the next. With a cache, files that have not changed since they
+		// were last hashed are not read at all.
+		class file_hasher {
+			std::vector<std::pair<hash_file::algorithm, std::unique_ptr<hasher>>> _hashers;
+			std::vector<hash_file::algorithm> _algorithms;
+			hash_file::read_mode _mode;
+			hash_file::digest_format _format;
+			hash_cache* _p_cache;
+
+			// buffer for buffered reads
+			std::vector<char> _buffer;
+
+			// page-aligned buffer for direct reads, large enough for two blocks
+			void* _p_aligned;
+
+			// whether any hasher works on several threads; those are never given mapped memory
+			bool _parallel;
+
+			// add data to every hasher
+			void feed(const char* data, size_t size);
+
+			// add mapped data to every hasher; returns false if the pages could not be read in
+			bool feed_mapped(const char* data, size_t size);
+
+			bool read_buffered(const std::string& fullpath,
+				const std::function<bool()>& cancelled,
+				unsigned long long& size,
+				std::string& error);
+
+			bool read_mapped(const std::string& fullpath,
+				const std::function<bool()>& cancelled,
+				unsigned long long& size,
+				std::string& error);
+
+			bool read_direct(const std::string& fullpath,
+				const std::function<bool()>& cancelled,
+				unsigned long long& size,
+				std::string& error);
+
+		public:
+			file_hasher(const std::vector<hash_file::algorithm>& algorithms,
+				hash_file::read_mode mode = hash_file::read_mode::automatic,
+				hash_cache* p_cache = nullptr,
+				hash_file::digest_format format = hash_file::digest_format::hex);
+			~file_hasher();
+
+			// cancelled is checked before each chunk of the file is hashed; size receives the
+			// size of the file
+			bool hash(const std::string& fullpath,
+				const std::function<bool()>& cancelled,
+				hash_file::hash_results& results,
+				unsigned long long& size,
+				std::string& error);
+
+			// Copying an object of this class is not allowed
+			file_hasher(const file_hasher&) = delete;
+			file_hasher& operator=(const file_hasher&) = delete;
+		};
+	}
+}
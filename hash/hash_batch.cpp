@@ -0,0 +1,491 @@
+//
+// hash_batch.cpp - batch file hashing implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../hash.h"
+#include "file_hasher.h"
+#include "../executor/async_task.h"
+#include <cryptlib.h>
+
+#include <filesystem>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+using namespace liblec::leccore;
+
+// the maximum number of listed files waiting to be hashed; once reached the lister hashes files
+// itself until the queue drains, which keeps memory bounded on very large directory trees
+static const size_t _max_queued = 4096;
+
+class hash_batch::impl {
+	// state shared by the coordinator and the lanes of a single batch
+	//
+	// Lanes are submitted to the executor and may only get to run after the coordinator is done,
+	// e.g. when the executor has a single worker. A lane registers as active only while the batch
+	// is open, and the coordinator closes the batch and waits for the active lanes before it
+	// returns, so no lane touches the impl once the batch is complete.
+	struct batch_state {
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::deque<std::string> queue;
+		bool listing_done = false;
+		bool closed = false;
+		unsigned int active = 0;
+	};
+
+public:
+	std::vector<std::string> _fullpaths;
+	std::string _directory;
+	bool _recursive = false;
+	bool _list_mode = true;
+	std::vector<hash_file::algorithm> _algorithms;
+	unsigned int _workers = 0;
+	hash_file::read_mode _read_mode = hash_file::read_mode::automatic;
+	hash_file::digest_format _digest_format = hash_file::digest_format::hex;
+	hash_cache* _p_cache = nullptr;
+
+	std::function<void(const file_result&)> _on_file_hashed;
+
+	std::mutex _results_mtx;
+	std::vector<file_result> _results;
+
+	std::atomic<unsigned long long> _files_total = 0;
+	std::atomic<unsigned long long> _files_done = 0;
+	std::atomic<unsigned long long> _files_failed = 0;
+	std::atomic<unsigned long long> _bytes_hashed = 0;
+
+	std::mutex _time_mtx;
+	std::chrono::steady_clock::time_point _start_time;
+	std::chrono::steady_clock::time_point _end_time;
+	bool _ended = false;
+
+	struct do_batch_result {
+		bool success = false;
+		std::string error;
+	};
+
+	async_task<do_batch_result> _task;
+
+	impl() {}
+	~impl() {}
+
+	void reset() {
+		_files_total = 0;
+		_files_done = 0;
+		_files_failed = 0;
+		_bytes_hashed = 0;
+
+		{
+			std::lock_guard<std::mutex> lock(_results_mtx);
+			_results.clear();
+		}
+
+		std::lock_guard<std::mutex> lock(_time_mtx);
+		_start_time = std::chrono::steady_clock::now();
+		_ended = false;
+	}
+
+	void ended() {
+		std::lock_guard<std::mutex> lock(_time_mtx);
+		_end_time = std::chrono::steady_clock::now();
+		_ended = true;
+	}
+
+	double seconds() {
+		std::lock_guard<std::mutex> lock(_time_mtx);
+		const auto end_time = _ended ? _end_time : std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(end_time - _start_time).count();
+	}
+
+	bool cancelled() const {
+		return _task.cancelled();
+	}
+
+	// wait for the next file to hash; returns false when there are none left
+	bool next(batch_state& state, std::string& fullpath) {
+		std::unique_lock<std::mutex> lock(state.mtx);
+		state.cv.wait(lock, [this, &state]() {
+			return !state.queue.empty() || state.listing_done || cancelled();
+			});
+
+		if (state.queue.empty() || cancelled())
+			return false;
+
+		fullpath = std::move(state.queue.front());
+		state.queue.pop_front();
+		return true;
+	}
+
+	void hash_one(file_hasher& fh, const std::string& fullpath) {
+		file_result result;
+		result.fullpath = fullpath;
+		result.size = 0;
+
+		try {
+			result.success = fh.hash(fullpath, [this]() { return cancelled(); },
+				result.hashes, result.size, result.error);
+		}
+		catch (const CryptoPP::Exception& e) {
+			result.error = e.what();
+			result.success = false;
+		}
+		catch (const std::exception& e) {
+			result.error = e.what();
+			result.success = false;
+		}
+
+		// a file interrupted by cancellation counts as not processed
+		if (!result.success && cancelled())
+			return;
+
+		_bytes_hashed += result.size;
+
+		if (!result.success)
+			_files_failed++;
+
+		if (_on_file_hashed) {
+			try {
+				_on_file_hashed(result);
+			}
+			catch (...) {
+				// to-do: log
+			}
+		}
+		else {
+			std::lock_guard<std::mutex> lock(_results_mtx);
+			_results.push_back(std::move(result));
+		}
+
+		_files_done++;
+	}
+
+	void run_lane(batch_state& state, file_hasher& fh) {
+		std::string fullpath;
+		while (next(state, fullpath))
+			hash_one(fh, fullpath);
+	}
+
+	static void lane_func(std::shared_ptr<batch_state> p_state, hash_batch::impl* p_impl) {
+		{
+			std::lock_guard<std::mutex> lock(p_state->mtx);
+			if (p_state->closed)
+				return;
+
+			p_state->active++;
+		}
+
+		try {
+			file_hasher fh(p_impl->_algorithms, p_impl->_read_mode, p_impl->_p_cache,
+				p_impl->_digest_format);
+			p_impl->run_lane(*p_state, fh);
+		}
+		catch (...) {
+			// the remaining files are picked up by the other lanes and the coordinator
+		}
+
+		std::lock_guard<std::mutex> lock(p_state->mtx);
+		p_state->active--;
+		p_state->cv.notify_all();
+	}
+
+	void enqueue(batch_state& state, file_hasher& fh, std::string fullpath) {
+		_files_total++;
+
+		std::unique_lock<std::mutex> lock(state.mtx);
+		if (state.queue.size() >= _max_queued) {
+			// hash the oldest file here rather than let the queue grow without bound
+			std::string oldest = std::move(state.queue.front());
+			state.queue.pop_front();
+			state.queue.push_back(std::move(fullpath));
+			lock.unlock();
+
+			hash_one(fh, oldest);
+			return;
+		}
+
+		state.queue.push_back(std::move(fullpath));
+		lock.unlock();
+		state.cv.notify_one();
+	}
+
+	bool list_directory(batch_state& state, file_hasher& fh, std::string& error) {
+		namespace fs = std::filesystem;
+
+		std::error_code code;
+		if (!fs::is_directory(_directory, code)) {
+			error = _directory + " is not a directory";
+			return false;
+		}
+
+		const auto options = fs::directory_options::skip_permission_denied;
+
+		auto visit = [&](const fs::directory_entry& entry) {
+			std::error_code code;
+			if (entry.is_regular_file(code))
+				enqueue(state, fh, entry.path().string());
+		};
+
+		if (_recursive) {
+			fs::recursive_directory_iterator it(_directory, options, code), end;
+			for (; !code && it != end && !cancelled(); it.increment(code))
+				visit(*it);
+		}
+		else {
+			fs::directory_iterator it(_directory, options, code), end;
+			for (; !code && it != end && !cancelled(); it.increment(code))
+				visit(*it);
+		}
+
+		if (code) {
+			error = code.message();
+			return false;
+		}
+
+		return true;
+	}
+
+	static do_batch_result batch_func(hash_batch::impl* p_impl) {
+		hash_batch::impl& _d = *p_impl;
+
+		do_batch_result result;
+		result.error.clear();
+		result.success = false;
+
+		if (_d._algorithms.empty()) {
+			result.error = "Algorithms not specified";
+			result.success = false;
+			_d.ended();
+			return result;
+		}
+
+		if (!_d._list_mode && _d._directory.empty()) {
+			result.error = "Directory not specified";
+			result.success = false;
+			_d.ended();
+			return result;
+		}
+
+		auto p_state = std::make_shared<batch_state>();
+		batch_state& state = *p_state;
+
+		try {
+			file_hasher fh(_d._algorithms, _d._read_mode, _d._p_cache, _d._digest_format);
+
+			unsigned int workers = _d._workers;
+			if (workers == 0)
+				workers = std::thread::hardware_concurrency();
+
+			if (workers == 0)
+				workers = 1;
+
+			if (_d._list_mode && workers > _d._fullpaths.size())
+				workers = static_cast<unsigned int>(_d._fullpaths.size());
+
+			// this thread is one of the workers; hashing begins while the files are still being listed
+			for (unsigned int i = 1; i < workers; i++)
+				default_executor().submit([p_state, p_impl]() { lane_func(p_state, p_impl); });
+
+			bool listed = true;
+
+			if (_d._list_mode) {
+				std::lock_guard<std::mutex> lock(state.mtx);
+				_d._files_total = _d._fullpaths.size();
+				state.queue.assign(std::make_move_iterator(_d._fullpaths.begin()),
+					std::make_move_iterator(_d._fullpaths.end()));
+				_d._fullpaths.clear();
+			}
+			else
+				listed = _d.list_directory(state, fh, result.error);
+
+			{
+				std::lock_guard<std::mutex> lock(state.mtx);
+				state.listing_done = true;
+			}
+			state.cv.notify_all();
+
+			if (listed)
+				_d.run_lane(state, fh);
+
+			result.success = listed;
+		}
+		catch (const std::exception& e) {
+			result.error = e.what();
+			result.success = false;
+		}
+
+		{
+			// lanes that have not started by now never will
+			std::unique_lock<std::mutex> lock(state.mtx);
+			state.listing_done = true;
+			state.closed = true;
+			state.queue.clear();
+			state.cv.notify_all();
+			state.cv.wait(lock, [&state]() { return state.active == 0; });
+		}
+
+		if (_d.cancelled()) {
+			result.error = "Operation cancelled";
+			result.success = false;
+		}
+
+		_d.ended();
+		return result;
+	}
+
+	void start() {
+		reset();
+		_task.start(batch_func, this);
+	}
+};
+
+hash_batch::hash_batch() : _d(*new impl()) {}
+hash_batch::~hash_batch() {
+	_d._task.cancel();
+	_d._task.join();
+
+	delete& _d;
+}
+
+void hash_batch::start(const std::vector<std::string>& fullpaths,
+	const std::vector<hash_file::algorithm>& algorithms,
+	unsigned int workers) {
+	if (hashing()) {
+		// allow only one instance
+		return;
+	}
+
+	_d._list_mode = true;
+	_d._fullpaths = fullpaths;
+	_d._directory.clear();
+	_d._recursive = false;
+	_d._algorithms = algorithms;
+	_d._workers = workers;
+
+	// run task asynchronously
+	_d.start();
+}
+
+void hash_batch::start(const std::string& directory,
+	bool recursive,
+	const std::vector<hash_file::algorithm>& algorithms,
+	unsigned int workers) {
+	if (hashing()) {
+		// allow only one instance
+		return;
+	}
+
+	_d._list_mode = false;
+	_d._fullpaths.clear();
+	_d._directory = directory;
+	_d._recursive = recursive;
+	_d._algorithms = algorithms;
+	_d._workers = workers;
+
+	// run task asynchronously
+	_d.start();
+}
+
+bool hash_batch::hashing() {
+	return _d._task.running();
+}
+
+bool hash_batch::hashing(batch_progress& progress) {
+	progress.files_total = _d._files_total;
+	progress.files_done = _d._files_done;
+	progress.files_failed = _d._files_failed;
+	progress.bytes_hashed = _d._bytes_hashed;
+	progress.seconds = _d.seconds();
+	progress.throughput = progress.seconds > 0.0 ?
+		static_cast<double>(progress.bytes_hashed) / progress.seconds : 0.0;
+
+	return hashing();
+}
+
+void hash_batch::on_file_hashed(std::function<void(const file_result&)> callback) {
+	if (hashing())
+		return;
+
+	_d._on_file_hashed = callback;
+}
+
+void hash_batch::set_read_mode(hash_file::read_mode mode) {
+	if (hashing())
+		return;
+
+	_d._read_mode = mode;
+}
+
+void hash_batch::set_digest_format(hash_file::digest_format format) {
+	if (hashing())
+		return;
+
+	_d._digest_format = format;
+}
+
+void hash_batch::set_cache(hash_cache* p_cache) {
+	if (hashing())
+		return;
+
+	_d._p_cache = p_cache;
+}
+
+size_t hash_batch::results(std::vector<file_result>& results) {
+	std::vector<file_result> ready;
+	{
+		std::lock_guard<std::mutex> lock(_d._results_mtx);
+		ready.swap(_d._results);
+	}
+
+	for (auto& it : ready)
+		results.push_back(std::move(it));
+
+	return ready.size();
+}
+
+bool hash_batch::result(std::string& error) {
+	error.clear();
+
+	if (hashing()) {
+		error = "Task not yet complete";
+		return false;
+	}
+
+	if (_d._task.valid()) {
+		auto result = _d._task.get();
+		error = result.error;
+		return result.success;
+	}
+
+	error = "unexpected error";
+	return false;
+}
+
+void hash_batch::on_complete(std::function<void()> callback) {
+	_d._task.on_complete(callback);
+}
+
+bool hash_batch::wait(unsigned long long timeout_milliseconds) {
+	return _d._task.wait(timeout_milliseconds);
+}
+
+void* hash_batch::completion_event() {
+	return _d._task.completion_event();
+}
+
+void hash_batch::cancel() {
+	_d._task.cancel();
+}
+
+void hash_batch::set_cancellation_token(const cancellation_token& token) {
+	_d._task.link(token);
+}
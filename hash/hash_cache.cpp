@@ -0,0 +1,381 @@
+//
+// hash_cache.cpp - persistent file hash cache implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../hash.h"
+#include "../database.h"
+
+#include <mutex>
+#include <filesystem>
+#include <algorithm>
+#include <climits>
+#include <Windows.h>
+
+using namespace liblec::leccore;
+
+// number of stores between checks of the number of entries
+static const unsigned int _trim_interval = 1024;
+
+// files written to less than this long before they are stamped are not cached; a write that
+// lands within the resolution of the file system's timestamps would otherwise go unnoticed
+static const unsigned long long _settle_time = 2ULL * 10000000ULL;	// 2 seconds, in 100ns units
+
+// the number of paths checked per transaction when compacting
+static const int _compact_page = 1000;
+
+namespace {
+	unsigned long long to_ull(DWORD high, DWORD low) {
+		return (static_cast<unsigned long long>(high) << 32) | low;
+	}
+
+	unsigned long long now() {
+		FILETIME ft;
+		GetSystemTimeAsFileTime(&ft);
+		return to_ull(ft.dwHighDateTime, ft.dwLowDateTime);
+	}
+
+	// days since 1601, which is enough resolution for ageing out entries and fits in an int
+	int today() {
+		return static_cast<int>(now() / (86400ULL * 10000000ULL));
+	}
+}
+
+class hash_cache::impl {
+public:
+	database::connection _con;
+	std::mutex _mtx;
+	unsigned int _max_entries = 1000000;
+	unsigned int _stores = 0;
+
+	impl(const std::string& fullpath) :
+		_con("sqlcipher", fullpath, "") {}
+	~impl() {
+		std::string error;
+		_con.disconnect(error);
+	}
+
+	// the 64 bit values are stored as text because the connection binds 32 bit integers only
+	static bool read_stamp(const std::string& fullpath, file_stamp& stamp) {
+		// no access rights are needed to read the file's information, and backup semantics
+		// allow directories to be opened, which are then rejected below
+		HANDLE handle = CreateFileA(fullpath.c_str(), 0,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+			OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+
+		if (handle == INVALID_HANDLE_VALUE)
+			return false;
+
+		BY_HANDLE_FILE_INFORMATION info;
+		const bool success = GetFileInformationByHandle(handle, &info) != FALSE;
+		CloseHandle(handle);
+
+		if (!success || (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			return false;
+
+		stamp.size = to_ull(info.nFileSizeHigh, info.nFileSizeLow);
+		stamp.modified = to_ull(info.ftLastWriteTime.dwHighDateTime, info.ftLastWriteTime.dwLowDateTime);
+		stamp.file_id = std::to_string(info.dwVolumeSerialNumber) + ":" +
+			std::to_string(to_ull(info.nFileIndexHigh, info.nFileIndexLow));
+		return true;
+	}
+
+	static bool same(const file_stamp& a, const file_stamp& b) {
+		return a.size == b.size && a.modified == b.modified && a.file_id == b.file_id;
+	}
+
+	// remove the least recently used entries in excess of the maximum
+	bool trim(std::string& error) {
+		database::table results;
+		if (!_con.execute_query("SELECT COUNT(*) AS Entries FROM Hashes;", {}, results, error))
+			return false;
+
+		if (results.data.empty() || results.data[0].count("Entries") == 0)
+			return true;
+
+		const int entries = database::get::integer(results.data[0].at("Entries"));
+		if (entries <= static_cast<int>(_max_entries))
+			return true;
+
+		return _con.execute("DELETE FROM Hashes WHERE rowid IN "
+			"(SELECT rowid FROM Hashes ORDER BY LastUsed LIMIT ?);",
+			{ entries - static_cast<int>(_max_entries) }, error);
+	}
+
+	// drop the entries of the paths that no longer match the file on disk
+	bool forget_changed(const std::vector<std::string>& paths, std::string& error) {
+		if (!_con.execute("BEGIN IMMEDIATE;", {}, error))
+			return false;
+
+		for (const auto& path : paths) {
+			file_stamp stamp;
+			bool success = false;
+
+			if (read_stamp(path, stamp))
+				success = _con.execute("DELETE FROM Hashes WHERE Path = ? AND "
+					"(Size <> ? OR Modified <> ? OR FileID <> ?);",
+					{ path, std::to_string(stamp.size), std::to_string(stamp.modified), stamp.file_id }, error);
+			else
+				success = _con.execute("DELETE FROM Hashes WHERE Path = ?;", { path }, error);
+
+			if (!success) {
+				std::string rollback_error;
+				_con.execute("ROLLBACK;", {}, rollback_error);
+				return false;
+			}
+		}
+
+		return _con.execute("COMMIT;", {}, error);
+	}
+};
+
+hash_cache::hash_cache(const std::string& fullpath) :
+	_d(*new impl(fullpath)) {}
+
+hash_cache::~hash_cache() {
+	delete& _d;
+}
+
+bool hash_cache::open(std::string& error) {
+	std::lock_guard<std::mutex> lock(_d._mtx);
+	error.clear();
+
+	if (_d._con.connected())
+		return true;
+
+	if (!_d._con.connect(error))
+		return false;
+
+	database::table results;
+
+	// wait for other processes instead of failing when they hold the lock, write ahead logging
+	// so that readers and the writer do not block each other, and no flush on every commit;
+	// a crash can lose the last few entries but cannot corrupt the file
+	if (!_d._con.execute_query("PRAGMA busy_timeout = 10000;", {}, results, error) ||
+		!_d._con.execute_query("PRAGMA journal_mode = WAL;", {}, results, error) ||
+		!_d._con.execute("PRAGMA synchronous = NORMAL;", {}, error) ||
+		!_d._con.execute("PRAGMA cache_size = -2048;", {}, error)) {
+		std::string disconnect_error;
+		_d._con.disconnect(disconnect_error);
+		return false;
+	}
+
+	if (!_d._con.execute("CREATE TABLE IF NOT EXISTS Hashes ("
+		"Path TEXT NOT NULL COLLATE NOCASE, "
+		"Algorithm INTEGER NOT NULL, "
+		"Size TEXT NOT NULL, "
+		"Modified TEXT NOT NULL, "
+		"FileID TEXT NOT NULL, "
+		"Hash TEXT NOT NULL, "
+		"LastUsed INTEGER NOT NULL, "
+		"PRIMARY KEY (Path, Algorithm));", {}, error) ||
+		!_d._con.execute("CREATE INDEX IF NOT EXISTS HashesLastUsed ON Hashes (LastUsed);", {}, error)) {
+		std::string disconnect_error;
+		_d._con.disconnect(disconnect_error);
+		return false;
+	}
+
+	return true;
+}
+
+bool hash_cache::is_open() {
+	std::lock_guard<std::mutex> lock(_d._mtx);
+	return _d._con.connected();
+}
+
+void hash_cache::set_max_entries(unsigned int max_entries) {
+	std::lock_guard<std::mutex> lock(_d._mtx);
+	_d._max_entries = (std::min)(max_entries, static_cast<unsigned int>(INT_MAX));
+}
+
+bool hash_cache::compact(std::string& error) {
+	std::lock_guard<std::mutex> lock(_d._mtx);
+	error.clear();
+
+	if (!_d._con.connected()) {
+		error = "Cache not open";
+		return false;
+	}
+
+	try {
+		// go through the paths a page at a time so that memory stays bounded
+		std::string last;
+
+		while (true) {
+			database::table results;
+			if (!_d._con.execute_query("SELECT DISTINCT Path FROM Hashes WHERE Path > ? ORDER BY Path LIMIT ?;",
+				{ last, _compact_page }, results, error))
+				return false;
+
+			std::vector<std::string> paths;
+			for (const auto& row : results.data)
+				if (row.count("Path"))
+					paths.push_back(database::get::text(row.at("Path")));
+
+			if (paths.empty())
+				break;
+
+			if (!_d.forget_changed(paths, error))
+				return false;
+
+			if (paths.size() < static_cast<size_t>(_compact_page))
+				break;
+
+			last = paths.back();
+		}
+
+		if (!_d.trim(error))
+			return false;
+	}
+	catch (const std::exception& e) {
+		error = e.what();
+		return false;
+	}
+
+	// fold the log back into the database, then rebuild the file without the free pages
+	database::table results;
+	return _d._con.execute_query("PRAGMA wal_checkpoint(TRUNCATE);", {}, results, error) &&
+		_d._con.execute("VACUUM;", {}, error);
+}
+
+bool hash_cache::clear(std::string& error) {
+	std::lock_guard<std::mutex> lock(_d._mtx);
+	error.clear();
+
+	if (!_d._con.connected()) {
+		error = "Cache not open";
+		return false;
+	}
+
+	return _d._con.execute("DELETE FROM Hashes;", {}, error);
+}
+
+bool hash_cache::get_stamp(const std::string& fullpath, file_stamp& stamp) {
+	if (!is_open())
+		return false;
+
+	// the same file is always found under the same key, however it was named
+	std::error_code code;
+	const auto path = std::filesystem::absolute(fullpath, code);
+	if (code)
+		return false;
+
+	stamp.path = path.lexically_normal().string();
+	return impl::read_stamp(stamp.path, stamp);
+}
+
+bool hash_cache::lookup(const file_stamp& stamp,
+	const std::vector<hash_file::algorithm>& algorithms,
+	hash_file::hash_results& results) {
+	std::lock_guard<std::mutex> lock(_d._mtx);
+	results.clear();
+
+	if (algorithms.empty())
+		return false;
+
+	try {
+		std::string error;
+		database::table rows;
+		if (!_d._con.execute_query("SELECT Algorithm, Size, Modified, FileID, Hash, LastUsed "
+			"FROM Hashes WHERE Path = ?;", { stamp.path }, rows, error))
+			return false;
+
+		bool stale_use = false;
+
+		for (const auto& row : rows.data) {
+			if (row.count("Algorithm") == 0 || row.count("Size") == 0 || row.count("Modified") == 0 ||
+				row.count("FileID") == 0 || row.count("Hash") == 0 || row.count("LastUsed") == 0)
+				continue;
+
+			file_stamp cached;
+			cached.size = std::stoull(database::get::text(row.at("Size")));
+			cached.modified = std::stoull(database::get::text(row.at("Modified")));
+			cached.file_id = database::get::text(row.at("FileID"));
+
+			if (!impl::same(cached, stamp))
+				continue;
+
+			const auto algo = static_cast<hash_file::algorithm>(database::get::integer(row.at("Algorithm")));
+			results[algo] = database::get::text(row.at("Hash"));
+
+			if (database::get::integer(row.at("LastUsed")) < today())
+				stale_use = true;
+		}
+
+		for (const auto& algo : algorithms) {
+			if (results.count(algo) == 0) {
+				results.clear();
+				return false;
+			}
+		}
+
+		// usage is recorded by the day, so a file that is looked up often costs one write a day
+		if (stale_use)
+			_d._con.execute("UPDATE Hashes SET LastUsed = ? WHERE Path = ?;", { today(), stamp.path }, error);
+
+		// drop the hashes that were not asked for
+		for (auto it = results.begin(); it != results.end();) {
+			if (std::find(algorithms.begin(), algorithms.end(), it->first) == algorithms.end())
+				it = results.erase(it);
+			else
+				it++;
+		}
+
+		return true;
+	}
+	catch (const std::exception&) {
+		// a malformed entry; the file is simply hashed again, which replaces it
+		results.clear();
+		return false;
+	}
+}
+
+void hash_cache::store(const file_stamp& stamp,
+	const hash_file::hash_results& results) {
+	if (results.empty())
+		return;
+
+	// the hashes describe the file as it was stamped; if it has changed since, or may yet change
+	// without its stamp changing, they cannot be trusted later
+	file_stamp current;
+	if (!impl::read_stamp(stamp.path, current) || !impl::same(current, stamp) ||
+		now() < stamp.modified + _settle_time)
+		return;
+
+	std::lock_guard<std::mutex> lock(_d._mtx);
+
+	std::string error;
+	if (!_d._con.execute("BEGIN IMMEDIATE;", {}, error))
+		return;
+
+	const std::string size = std::to_string(stamp.size);
+	const std::string modified = std::to_string(stamp.modified);
+	const int last_used = today();
+
+	for (const auto& it : results) {
+		if (!_d._con.execute("INSERT OR REPLACE INTO Hashes "
+			"(Path, Algorithm, Size, Modified, FileID, Hash, LastUsed) VALUES (?, ?, ?, ?, ?, ?, ?);",
+			{ stamp.path, static_cast<int>(it.first), size, modified, stamp.file_id, it.second, last_used },
+			error)) {
+			_d._con.execute("ROLLBACK;", {}, error);
+			return;
+		}
+	}
+
+	if (!_d._con.execute("COMMIT;", {}, error)) {
+		_d._con.execute("ROLLBACK;", {}, error);
+		return;
+	}
+
+	if (++_d._stores % _trim_interval == 0) {
+		try {
+			_d.trim(error);
+		}
+		catch (const std::exception&) {}
+	}
+}
@@ -9,14 +9,9 @@
 //
 
 #include "../hash.h"
-#include <thread>
-#include <future>
+#include "file_hasher.h"
+#include "../executor/async_task.h"
 #include <cryptlib.h>
-#include <sha.h>
-#include <hex.h>
-#include <files.h>
-#include <filters.h>
-#include <channels.h>
 
 using namespace liblec::leccore;
 
@@ -24,6 +19,9 @@ class hash_file::impl {
 public:
 	std::string _fullpath;
 	std::vector<algorithm> _algorithms;
+	read_mode _read_mode = read_mode::automatic;
+	digest_format _digest_format = digest_format::hex;
+	hash_cache* _p_cache = nullptr;
 
 	struct do_hash_result {
 		bool success = false;
@@ -31,7 +29,7 @@ public:
 		std::map<algorithm, std::string> hashes;
 	};
 
-	std::future<do_hash_result> _fut;
+	async_task<do_hash_result> _task;
 
 	impl() {}
 	~impl() {}
@@ -57,30 +55,11 @@ public:
 		}
 
 		try {
-			CryptoPP::ChannelSwitch cs;
-			std::map<algorithm, CryptoPP::HashFilter> filters;
-
-			CryptoPP::SHA256 sha256_hash;
-			CryptoPP::SHA512 sha512_hash;
-
-			for (const auto& algo : _d._algorithms)	{
-				result.hashes[algo] = "";
-
-				if (algo == algorithm::sha256) {
-					filters.try_emplace(algo, sha256_hash,
-						new CryptoPP::HexEncoder(new CryptoPP::StringSink(result.hashes.at(algo)), false));
-					cs.AddDefaultRoute(filters.at(algo));
-				}
-				if (algo == algorithm::sha512) {
-					filters.try_emplace(algo, sha512_hash,
-						new CryptoPP::HexEncoder(new CryptoPP::StringSink(result.hashes.at(algo)), false));
-					cs.AddDefaultRoute(filters.at(algo));
-				}
-			}
-
-			CryptoPP::FileSource fs(_d._fullpath.c_str(), true, new CryptoPP::Redirector(cs));
-
-			result.success = true;
+			file_hasher fh(_d._algorithms, _d._read_mode, _d._p_cache, _d._digest_format);
+			unsigned long long size = 0;
+
+			result.success = fh.hash(_d._fullpath, [&_d]() { return _d._task.cancelled(); },
+				result.hashes, size, result.error);
 			return result;
 		}
 		catch (const CryptoPP::Exception& e) {
@@ -98,8 +77,8 @@ public:
 
 hash_file::hash_file() : _d(*new impl()) {}
 liblec::leccore::hash_file::~hash_file() {
-	if (_d._fut.valid())
-		_d._fut.get();
+	_d._task.cancel();
+	_d._task.join();
 
 	delete& _d;
 }
@@ -115,15 +94,33 @@ void hash_file::start(const std::string& fullpath,
 	_d._algorithms = algorithms;
 
 	// run task asynchronously
-	_d._fut = std::async(std::launch::async, _d.hash_func, &_d);
+	_d._task.start(_d.hash_func, &_d);
 	return;
 }
 
+void hash_file::set_read_mode(read_mode mode) {
+	if (hashing())
+		return;
+
+	_d._read_mode = mode;
+}
+
+void hash_file::set_digest_format(digest_format format) {
+	if (hashing())
+		return;
+
+	_d._digest_format = format;
+}
+
+void hash_file::set_cache(hash_cache* p_cache) {
+	if (hashing())
+		return;
+
+	_d._p_cache = p_cache;
+}
+
 bool hash_file::hashing() {
-	if (_d._fut.valid())
-		return _d._fut.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready;
-	else
-		return false;
+	return _d._task.running();
 }
 
 bool hash_file::result(hash_results& results,
@@ -136,8 +133,8 @@ bool hash_file::result(hash_results& results,
 		return false;
 	}
 
-	if (_d._fut.valid()) {
-		auto result = _d._fut.get();
+	if (_d._task.valid()) {
+		auto result = _d._task.get();
 		results = result.hashes;
 		error = result.error;
 		return result.success;
@@ -146,3 +143,23 @@ bool hash_file::result(hash_results& results,
 	error = "unexpected error";
 	return false;
 }
+
+void hash_file::on_complete(std::function<void()> callback) {
+	_d._task.on_complete(callback);
+}
+
+bool hash_file::wait(unsigned long long timeout_milliseconds) {
+	return _d._task.wait(timeout_milliseconds);
+}
+
+void* hash_file::completion_event() {
+	return _d._task.completion_event();
+}
+
+void hash_file::cancel() {
+	_d._task.cancel();
+}
+
+void hash_file::set_cancellation_token(const cancellation_token& token) {
+	_d._task.link(token);
+}
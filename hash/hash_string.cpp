@@ -9,59 +9,248 @@
 //
 
 #include "../hash.h"
+#include "../encode.h"
+#include "blake3.h"
+#include "xxh3.h"
+#include "crc32c.h"
+#include "sha256_many.h"
 #include <cryptlib.h>
 #include <sha.h>
-#include <hex.h>
 #include <osrng.h>
 
-// for UuidToString, RpcStringFree
-#include <rpc.h>
-#pragma comment(lib, "rpcrt4.lib")
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+#include <algorithm>
 
-std::string liblec::leccore::hash_string::sha256(const std::string& input) {
-    try {
-        CryptoPP::SHA256 hash;
-        std::string output;
-        CryptoPP::StringSource ss(input, true,
-            new CryptoPP::HashFilter(hash,
-                new CryptoPP::HexEncoder(new CryptoPP::StringSink(output), false)));
-        return output;
-    }
-    catch (CryptoPP::Exception&) {
-        // to-do: log
+namespace {
+    std::string hex_hash(CryptoPP::HashTransformation& hash, std::string_view input) {
+        try {
+            // SHA512 has the largest digest of the supported algorithms
+            CryptoPP::byte digest[CryptoPP::SHA512::DIGESTSIZE];
+            hash.CalculateDigest(digest, reinterpret_cast<const CryptoPP::byte*>(input.data()), input.size());
+            return liblec::leccore::hash_string::to_hex(digest, hash.DigestSize());
+        }
+        catch (CryptoPP::Exception&) {
+            // to-do: log
+        }
+        catch (std::exception&) {
+            // to-do: log
+        }
+        return std::string();
     }
-    catch (std::exception&) {
-        // to-do: log
+
+    // A generator for one thread. Seeding an AutoSeededRandomPool reads from the operating
+    // system's generator, so each thread seeds one once and then only reseeds it periodically.
+    class random_generator {
+        // reseed after this much output or this much time, whichever comes first
+        static constexpr size_t _reseed_bytes = 1024 * 1024;
+        static constexpr std::chrono::minutes _reseed_interval{ 10 };
+
+        CryptoPP::AutoSeededRandomPool _rng;
+        size_t _generated = 0;
+        std::chrono::steady_clock::time_point _seeded = std::chrono::steady_clock::now();
+
+    public:
+        void generate(unsigned char* buffer, size_t length) {
+            while (length > 0) {
+                const auto now = std::chrono::steady_clock::now();
+
+                if (_generated >= _reseed_bytes || now - _seeded >= _reseed_interval) {
+                    _rng.Reseed();
+                    _generated = 0;
+                    _seeded = now;
+                }
+
+                // large requests are split so that the reseeding schedule still applies
+                const size_t take = (std::min)(length, _reseed_bytes - _generated);
+                _rng.GenerateBlock(buffer, take);
+
+                _generated += take;
+                buffer += take;
+                length -= take;
+            }
+        }
+    };
+
+    random_generator& thread_random_generator() {
+        // constructed, and seeded, on first use on each thread
+        static thread_local random_generator rng;
+        return rng;
     }
-    return std::string();
-}
 
-std::string liblec::leccore::hash_string::sha512(const std::string& input) {
-    try {
-        CryptoPP::SHA512 hash;
-        std::string output;
-        CryptoPP::StringSource ss(input, true,
-            new CryptoPP::HashFilter(hash,
-                new CryptoPP::HexEncoder(new CryptoPP::StringSink(output), false)));
-        return output;
+    const size_t _uuid_length = 36;
+
+    // 8-4-4-4-12 hex digits
+    void format_uuid(const unsigned char* bytes, char* text) {
+        static const size_t groups[] = { 4, 2, 2, 2, 6 };
+
+        for (size_t group = 0; group < 5; group++) {
+            if (group > 0)
+                *text++ = '-';
+
+            liblec::leccore::hash_string::to_hex(bytes, groups[group], text);
+            bytes += groups[group];
+            text += 2 * groups[group];
+        }
     }
-    catch (CryptoPP::Exception&) {
-        // to-do: log
+
+    // The last version 7 timestamp and counter handed out in this process. The 12 bit counter
+    // follows the timestamp; when it runs out within a millisecond the timestamp is moved on by
+    // one, and a clock that goes backwards is ignored, so the uuids only ever increase.
+    std::mutex _v7_mtx;
+    uint64_t _v7_milliseconds = 0;
+    unsigned int _v7_counter = 0;
+
+    // write the timestamp and counter into bytes 0 to 7 of count random uuids
+    void stamp_v7(unsigned char* bytes, size_t count) {
+        const uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+
+        std::lock_guard<std::mutex> lock(_v7_mtx);
+
+        for (size_t i = 0; i < count; i++) {
+            unsigned char* p_uuid = bytes + 16 * i;
+
+            if (now > _v7_milliseconds) {
+                _v7_milliseconds = now;
+
+                // a random start in the lower half leaves room for at least 2048 more
+                _v7_counter = ((static_cast<unsigned int>(p_uuid[6]) << 8) | p_uuid[7]) & 0x07ff;
+            }
+            else if (++_v7_counter > 0x0fff) {
+                _v7_milliseconds++;
+                _v7_counter = 0;
+            }
+
+            for (int b = 0; b < 6; b++)
+                p_uuid[b] = static_cast<unsigned char>(_v7_milliseconds >> (8 * (5 - b)));
+
+            p_uuid[6] = static_cast<unsigned char>(_v7_counter >> 8);
+            p_uuid[7] = static_cast<unsigned char>(_v7_counter);
+        }
     }
-    catch (std::exception&) {
-        // to-do: log
+
+    template <size_t size>
+    void raw_hash(CryptoPP::HashTransformation& hash, std::string_view input,
+        std::array<unsigned char, size>& digest) {
+        // the hash objects keep their state in fixed size blocks, so this does not allocate
+        hash.CalculateDigest(digest.data(), reinterpret_cast<const CryptoPP::byte*>(input.data()), input.size());
     }
-    return std::string();
+}
+
+std::string liblec::leccore::hash_string::sha256(std::string_view input) {
+    CryptoPP::SHA256 hash;
+    return hex_hash(hash, input);
+}
+
+std::string liblec::leccore::hash_string::sha256(const std::string& input) {
+    return sha256(std::string_view(input));
+}
+
+void liblec::leccore::hash_string::sha256(std::string_view input,
+    std::array<unsigned char, 32>& digest) {
+    CryptoPP::SHA256 hash;
+    raw_hash(hash, input, digest);
+}
+
+void liblec::leccore::hash_string::sha256(const std::vector<std::string_view>& inputs,
+    unsigned char* digests) {
+    sha256_many(inputs.data(), inputs.size(), digests);
+}
+
+std::string liblec::leccore::hash_string::sha512(std::string_view input) {
+    CryptoPP::SHA512 hash;
+    return hex_hash(hash, input);
+}
+
+std::string liblec::leccore::hash_string::sha512(const std::string& input) {
+    return sha512(std::string_view(input));
+}
+
+void liblec::leccore::hash_string::sha512(std::string_view input,
+    std::array<unsigned char, 64>& digest) {
+    CryptoPP::SHA512 hash;
+    raw_hash(hash, input, digest);
+}
+
+std::string liblec::leccore::hash_string::blake3(std::string_view input) {
+    blake3_hash hash;
+    return hex_hash(hash, input);
+}
+
+void liblec::leccore::hash_string::blake3(std::string_view input,
+    std::array<unsigned char, 32>& digest) {
+    blake3_hash hash;
+    raw_hash(hash, input, digest);
+}
+
+std::string liblec::leccore::hash_string::xxh3_64(std::string_view input) {
+    xxh3_hash hash(64);
+    return hex_hash(hash, input);
+}
+
+void liblec::leccore::hash_string::xxh3_64(std::string_view input,
+    std::array<unsigned char, 8>& digest) {
+    xxh3_hash hash(64);
+    raw_hash(hash, input, digest);
+}
+
+std::string liblec::leccore::hash_string::xxh3_128(std::string_view input) {
+    xxh3_hash hash(128);
+    return hex_hash(hash, input);
+}
+
+void liblec::leccore::hash_string::xxh3_128(std::string_view input,
+    std::array<unsigned char, 16>& digest) {
+    xxh3_hash hash(128);
+    raw_hash(hash, input, digest);
+}
+
+std::string liblec::leccore::hash_string::crc32c(std::string_view input) {
+    crc32c_hash hash;
+    return hex_hash(hash, input);
+}
+
+void liblec::leccore::hash_string::crc32c(std::string_view input,
+    std::array<unsigned char, 4>& digest) {
+    crc32c_hash hash;
+    raw_hash(hash, input, digest);
+}
+
+void liblec::leccore::hash_string::to_hex(const unsigned char* data,
+    size_t length,
+    char* hex) {
+    base16::encode(data, length, hex);
+}
+
+std::string liblec::leccore::hash_string::to_hex(const unsigned char* data,
+    size_t length) {
+    std::string hex(2 * length, '\0');
+    to_hex(data, length, &hex[0]);
+    return hex;
 }
 
 std::string liblec::leccore::hash_string::random_string(int length) {
+    if (length <= 0)
+        return std::string();
+
+    std::string random(static_cast<size_t>(length), '\0');
+    if (!random_bytes(reinterpret_cast<unsigned char*>(&random[0]), random.size()))
+        return std::string();
+
+    return random;
+}
+
+bool liblec::leccore::hash_string::random_bytes(unsigned char* buffer,
+    size_t length) {
+    if (length == 0)
+        return true;
+
     try {
-        std::string random;
-        CryptoPP::AutoSeededRandomPool rng;
-        CryptoPP::RandomNumberSource rns(rng, length, true,
-            new CryptoPP::StringSink(random)
-        );
-        return random;
+        random_generator& rng = thread_random_generator();
+        rng.generate(buffer, length);
+        return true;
     }
     catch (CryptoPP::Exception&) {
         // to-do: log
@@ -69,16 +258,47 @@ std::string liblec::leccore::hash_string::random_string(int length) {
     catch (std::exception&) {
         // to-do: log
     }
-    return std::string();
+    return false;
 }
 
 std::string liblec::leccore::hash_string::uuid() {
-    std::string uuid_string;
-    UUID uuid;
-    UuidCreate(&uuid);
-    RPC_CSTR uuidStr;
-    RPC_STATUS status = UuidToStringA(&uuid, &uuidStr);
-    uuid_string += reinterpret_cast<char*>(uuidStr);
-    RpcStringFreeA(&uuidStr);
-    return uuid_string;
+    return uuid(uuid_version::v4);
+}
+
+std::string liblec::leccore::hash_string::uuid(uuid_version version) {
+    std::string text(_uuid_length, '\0');
+    if (!uuids(version, 1, &text[0]))
+        return std::string();
+
+    return text;
+}
+
+bool liblec::leccore::hash_string::uuids(uuid_version version,
+    size_t count,
+    char* text) {
+    // the random bits of a run of uuids are drawn in one go
+    const size_t run = 256;
+    unsigned char bytes[run * 16];
+
+    for (size_t done = 0; done < count; done += run) {
+        const size_t uuids_in_run = (std::min)(run, count - done);
+
+        if (!random_bytes(bytes, uuids_in_run * 16))
+            return false;
+
+        if (version == uuid_version::v7)
+            stamp_v7(bytes, uuids_in_run);
+
+        for (size_t i = 0; i < uuids_in_run; i++) {
+            unsigned char* p_uuid = bytes + 16 * i;
+
+            // the version in the high nibble of byte 6 and the variant in the top two bits of byte 8
+            p_uuid[6] = static_cast<unsigned char>((p_uuid[6] & 0x0f) | (version == uuid_version::v7 ? 0x70 : 0x40));
+            p_uuid[8] = static_cast<unsigned char>((p_uuid[8] & 0x3f) | 0x80);
+
+            format_uuid(p_uuid, text + _uuid_length * (done + i));
+        }
+    }
+
+    return true;
 }
@@ -0,0 +1,81 @@
+//
+// hasher.cpp - incremental hashing implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../hash.h"
+#include "blake3.h"
+#include "xxh3.h"
+#include "crc32c.h"
+#include <cryptlib.h>
+#include <sha.h>
+#include <memory>
+#include <stdexcept>
+
+using namespace liblec::leccore;
+
+class hasher::impl {
+public:
+	std::unique_ptr<CryptoPP::HashTransformation> _p_hash;
+
+	impl(hash_file::algorithm algo) {
+		switch (algo) {
+		case hash_file::algorithm::sha512:
+			_p_hash = std::make_unique<CryptoPP::SHA512>();
+			break;
+		case hash_file::algorithm::blake3:
+			_p_hash = std::make_unique<blake3_hash>();
+			break;
+		case hash_file::algorithm::xxh3_64:
+			_p_hash = std::make_unique<xxh3_hash>(64);
+			break;
+		case hash_file::algorithm::xxh3_128:
+			_p_hash = std::make_unique<xxh3_hash>(128);
+			break;
+		case hash_file::algorithm::crc32c:
+			_p_hash = std::make_unique<crc32c_hash>();
+			break;
+		case hash_file::algorithm::sha256:
+			_p_hash = std::make_unique<CryptoPP::SHA256>();
+			break;
+		default:
+			// never hash with an algorithm other than the one asked for
+			throw std::invalid_argument("Unsupported hashing algorithm");
+		}
+	}
+	~impl() {}
+};
+
+hasher::hasher(hash_file::algorithm algo) : _d(*new impl(algo)) {}
+hasher::~hasher() { delete& _d; }
+
+void hasher::update(const void* data, size_t length) {
+	_d._p_hash->Update(reinterpret_cast<const CryptoPP::byte*>(data), length);
+}
+
+std::string hasher::finalize() {
+	// SHA512 has the largest digest of the supported algorithms
+	unsigned char digest[CryptoPP::SHA512::DIGESTSIZE];
+	const unsigned int size = digest_size();
+
+	finalize(digest);
+	return hash_string::to_hex(digest, size);
+}
+
+void hasher::finalize(unsigned char* digest) {
+	// Final() also restarts the hash
+	_d._p_hash->Final(digest);
+}
+
+unsigned int hasher::digest_size() {
+	return _d._p_hash->DigestSize();
+}
+
+void hasher::reset() {
+	_d._p_hash->Restart();
+}
@@ -0,0 +1,147 @@
+//
+// hmac.cpp - keyed-hash message authentication code implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "../hash.h"
+#include <cryptlib.h>
+#include <sha.h>
+#include <misc.h>
+#include <memory>
+#include <stdexcept>
+#include <cstring>
+
+using namespace liblec::leccore;
+
+namespace {
+	// the keyed states of one hash algorithm
+	class keyed_state {
+	public:
+		virtual ~keyed_state() {}
+		virtual unsigned int mac_size() const = 0;
+		virtual void compute(const CryptoPP::byte* data, size_t length, CryptoPP::byte* mac) const = 0;
+	};
+
+	template <typename hash_type>
+	class keyed_state_of : public keyed_state {
+		// the states after absorbing the key padded with 0x36 and with 0x5c bytes
+		hash_type _inner;
+		hash_type _outer;
+
+	public:
+		keyed_state_of(const std::string& key) {
+			CryptoPP::byte block[hash_type::BLOCKSIZE];
+			memset(block, 0, sizeof(block));
+
+			if (key.size() > sizeof(block))
+				hash_type().CalculateDigest(block, reinterpret_cast<const CryptoPP::byte*>(key.data()), key.size());
+			else
+				memcpy(block, key.data(), key.size());
+
+			for (auto& b : block)
+				b ^= 0x36;
+			_inner.Update(block, sizeof(block));
+
+			for (auto& b : block)
+				b ^= 0x36 ^ 0x5c;
+			_outer.Update(block, sizeof(block));
+
+			// the padded key is as secret as the key itself
+			CryptoPP::SecureWipeArray(block, sizeof(block));
+		}
+
+		unsigned int mac_size() const override {
+			return hash_type::DIGESTSIZE;
+		}
+
+		void compute(const CryptoPP::byte* data, size_t length, CryptoPP::byte* mac) const override {
+			// the hash objects hold their state in fixed size blocks, so the copies are plain
+			// memory copies
+			CryptoPP::byte inner_digest[hash_type::DIGESTSIZE];
+
+			hash_type inner(_inner);
+			inner.Update(data, length);
+			inner.Final(inner_digest);
+
+			hash_type outer(_outer);
+			outer.Update(inner_digest, sizeof(inner_digest));
+			outer.Final(mac);
+		}
+	};
+}
+
+class hmac::impl {
+public:
+	std::unique_ptr<keyed_state> _p_state;
+
+	impl(const std::string& key, algorithm algo) {
+		switch (algo) {
+		case algorithm::sha512:
+			_p_state = std::make_unique<keyed_state_of<CryptoPP::SHA512>>(key);
+			break;
+		case algorithm::sha256:
+			_p_state = std::make_unique<keyed_state_of<CryptoPP::SHA256>>(key);
+			break;
+		default:
+			// never compute a code with an algorithm other than the one asked for
+			throw std::invalid_argument("Unsupported HMAC algorithm");
+		}
+	}
+	~impl() {}
+};
+
+hmac::hmac(const std::string& key, algorithm algo) : _d(*new impl(key, algo)) {}
+hmac::~hmac() { delete& _d; }
+
+unsigned int hmac::mac_size() const {
+	return _d._p_state->mac_size();
+}
+
+void hmac::compute(const void* data, size_t length, unsigned char* mac) const {
+	_d._p_state->compute(reinterpret_cast<const CryptoPP::byte*>(data), length, mac);
+}
+
+std::string hmac::compute(const std::string& message) const {
+	// SHA512 has the largest digest of the supported algorithms
+	unsigned char mac[CryptoPP::SHA512::DIGESTSIZE];
+	compute(message.data(), message.size(), mac);
+	return hash_string::to_hex(mac, mac_size());
+}
+
+void hmac::compute(const std::vector<std::string_view>& messages, unsigned char* macs) const {
+	const unsigned int size = mac_size();
+
+	for (size_t i = 0; i < messages.size(); i++)
+		compute(messages[i].data(), messages[i].size(), macs + size * i);
+}
+
+bool hmac::verify(const void* data, size_t length,
+	const unsigned char* mac, size_t mac_length) const {
+	if (mac_length != mac_size())
+		return false;
+
+	unsigned char expected[CryptoPP::SHA512::DIGESTSIZE];
+	compute(data, length, expected);
+
+	return CryptoPP::VerifyBufsEqual(expected, mac, mac_length);
+}
+
+size_t hmac::verify(const std::vector<std::string_view>& messages,
+	const unsigned char* macs, bool* results) const {
+	const unsigned int size = mac_size();
+	size_t verified = 0;
+
+	for (size_t i = 0; i < messages.size(); i++) {
+		results[i] = verify(messages[i].data(), messages[i].size(), macs + size * i, size);
+
+		if (results[i])
+			verified++;
+	}
+
+	return verified;
+}
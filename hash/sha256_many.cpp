@@ -0,0 +1,217 @@
+//
+// sha256_many.cpp - batch SHA256 implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "sha256_many.h"
+#include <cryptlib.h>
+#include <sha.h>
+#include <cpu.h>
+
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define LECCORE_SHA256_AVX2
+#endif
+
+using namespace liblec::leccore;
+
+namespace {
+	void sha256_one_at_a_time(const std::string_view* inputs, size_t count, unsigned char* digests) {
+		// one object for the whole batch, and no pipeline, so nothing is allocated per string
+		CryptoPP::SHA256 hash;
+
+		for (size_t i = 0; i < count; i++)
+			hash.CalculateDigest(digests + CryptoPP::SHA256::DIGESTSIZE * i,
+				reinterpret_cast<const CryptoPP::byte*>(inputs[i].data()), inputs[i].size());
+	}
+
+#if defined(LECCORE_SHA256_AVX2)
+	const uint32_t _k[64] = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	const uint32_t _h0[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+
+	const size_t _lanes = 8;
+
+	// a message and its padding, split into 64 byte blocks
+	struct lane {
+		const uint8_t* data;
+		size_t blocks;
+
+		// the blocks from tail_block on hold the end of the message and the padding
+		size_t tail_block;
+		uint8_t tail[128];
+
+		void set(std::string_view input) {
+			const size_t length = input.size();
+			data = reinterpret_cast<const uint8_t*>(input.data());
+			tail_block = length / 64;
+
+			const size_t remainder = length - 64 * tail_block;
+			const size_t tail_length = remainder + 9 <= 64 ? 64 : 128;
+			blocks = tail_block + tail_length / 64;
+
+			memset(tail, 0, sizeof(tail));
+			memcpy(tail, data + 64 * tail_block, remainder);
+			tail[remainder] = 0x80;
+
+			const uint64_t bits = static_cast<uint64_t>(length) * 8;
+			for (size_t i = 0; i < 8; i++)
+				tail[tail_length - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+		}
+
+		const uint8_t* block(size_t index) const {
+			return index < tail_block ? data + 64 * index : tail + 64 * (index - tail_block);
+		}
+	};
+
+	inline __m256i rotr(__m256i x, int n) {
+		return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+	}
+
+	inline __m256i add(__m256i a, __m256i b) {
+		return _mm256_add_epi32(a, b);
+	}
+
+	inline __m256i xor3(__m256i a, __m256i b, __m256i c) {
+		return _mm256_xor_si256(_mm256_xor_si256(a, b), c);
+	}
+
+	inline uint32_t load_big_endian(const uint8_t* p) {
+		return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+			(static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+	}
+
+	// hash up to 8 messages, one per lane; lanes past count are idle
+	void sha256_lanes(const lane* lanes, size_t count, unsigned char* const* outputs) {
+		alignas(32) uint32_t words[_lanes];
+		size_t max_blocks = 0;
+
+		for (size_t l = 0; l < _lanes; l++) {
+			words[l] = l < count ? static_cast<uint32_t>(lanes[l].blocks) : 0;
+			max_blocks = (std::max)(max_blocks, static_cast<size_t>(words[l]));
+		}
+
+		const __m256i blocks = _mm256_load_si256(reinterpret_cast<const __m256i*>(words));
+
+		__m256i state[8];
+		for (int i = 0; i < 8; i++)
+			state[i] = _mm256_set1_epi32(static_cast<int>(_h0[i]));
+
+		for (size_t index = 0; index < max_blocks; index++) {
+			__m256i w[64];
+
+			for (int i = 0; i < 16; i++) {
+				for (size_t l = 0; l < _lanes; l++)
+					words[l] = l < count && index < lanes[l].blocks ? load_big_endian(lanes[l].block(index) + 4 * i) : 0;
+
+				w[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(words));
+			}
+
+			for (int i = 16; i < 64; i++) {
+				const __m256i s0 = xor3(rotr(w[i - 15], 7), rotr(w[i - 15], 18), _mm256_srli_epi32(w[i - 15], 3));
+				const __m256i s1 = xor3(rotr(w[i - 2], 17), rotr(w[i - 2], 19), _mm256_srli_epi32(w[i - 2], 10));
+				w[i] = add(add(w[i - 16], s0), add(w[i - 7], s1));
+			}
+
+			__m256i a = state[0], b = state[1], c = state[2], d = state[3];
+			__m256i e = state[4], f = state[5], g = state[6], h = state[7];
+
+			for (int i = 0; i < 64; i++) {
+				const __m256i s1 = xor3(rotr(e, 6), rotr(e, 11), rotr(e, 25));
+				const __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+				const __m256i t1 = add(add(add(h, s1), add(ch, _mm256_set1_epi32(static_cast<int>(_k[i])))), w[i]);
+				const __m256i s0 = xor3(rotr(a, 2), rotr(a, 13), rotr(a, 22));
+				const __m256i maj = xor3(_mm256_and_si256(a, b), _mm256_and_si256(a, c), _mm256_and_si256(b, c));
+				const __m256i t2 = add(s0, maj);
+
+				h = g;
+				g = f;
+				f = e;
+				e = add(d, t1);
+				d = c;
+				c = b;
+				b = a;
+				a = add(t1, t2);
+			}
+
+			// lanes whose message has no block at this index keep their state
+			const __m256i active = _mm256_cmpgt_epi32(blocks, _mm256_set1_epi32(static_cast<int>(index)));
+			const __m256i result[8] = { a, b, c, d, e, f, g, h };
+
+			for (int i = 0; i < 8; i++)
+				state[i] = _mm256_blendv_epi8(state[i], add(state[i], result[i]), active);
+		}
+
+		for (int i = 0; i < 8; i++) {
+			_mm256_store_si256(reinterpret_cast<__m256i*>(words), state[i]);
+
+			for (size_t l = 0; l < count; l++) {
+				outputs[l][4 * i] = static_cast<unsigned char>(words[l] >> 24);
+				outputs[l][4 * i + 1] = static_cast<unsigned char>(words[l] >> 16);
+				outputs[l][4 * i + 2] = static_cast<unsigned char>(words[l] >> 8);
+				outputs[l][4 * i + 3] = static_cast<unsigned char>(words[l]);
+			}
+		}
+	}
+
+	void sha256_avx2(const std::string_view* inputs, size_t count, unsigned char* digests) {
+		// group strings with the same number of blocks so that the lanes of a group finish together
+		std::vector<size_t> order(count);
+		for (size_t i = 0; i < count; i++)
+			order[i] = i;
+
+		std::stable_sort(order.begin(), order.end(), [inputs](size_t x, size_t y) {
+			return (inputs[x].size() + 9) / 64 < (inputs[y].size() + 9) / 64;
+			});
+
+		lane lanes[_lanes];
+		unsigned char* outputs[_lanes];
+
+		for (size_t done = 0; done < count; done += _lanes) {
+			const size_t group = (std::min)(_lanes, count - done);
+
+			for (size_t l = 0; l < group; l++) {
+				lanes[l].set(inputs[order[done + l]]);
+				outputs[l] = digests + CryptoPP::SHA256::DIGESTSIZE * order[done + l];
+			}
+
+			sha256_lanes(lanes, group, outputs);
+		}
+	}
+#endif
+}
+
+void liblec::leccore::sha256_many(const std::string_view* inputs, size_t count, unsigned char* digests) {
+#if defined(LECCORE_SHA256_AVX2)
+	static const bool use_avx2 = !CryptoPP::HasSHA() && CryptoPP::HasAVX2();
+
+	// a lone string gains nothing from the lanes
+	if (use_avx2 && count > 1) {
+		sha256_avx2(inputs, count, digests);
+		return;
+	}
+#endif
+
+	sha256_one_at_a_time(inputs, count, digests);
+}
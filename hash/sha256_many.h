@@ -0,0 +1,23 @@
+//
+// sha256_many.h - batch SHA256 interface
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include <string_view>
+
+namespace liblec {
+	namespace leccore {
+		// Hash count strings with SHA256 and write the 32 byte raw digests one after the other into
+		// digests. Processors with the SHA extensions hash one string at a time with them, through
+		// Crypto++. Otherwise, where AVX2 is available, eight strings are hashed at once, one per
+		// 32 bit lane; strings of similar length are grouped so the lanes finish together.
+		void sha256_many(const std::string_view* inputs, size_t count, unsigned char* digests);
+	}
+}
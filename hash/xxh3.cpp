@@ -0,0 +1,565 @@
+//
+// xxh3.cpp - XXH3 hash implementation
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#include "xxh3.h"
+#include <cpu.h>
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define LECCORE_XXH3_SIMD
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace liblec::leccore;
+
+namespace {
+	const uint32_t _prime32_1 = 0x9E3779B1U;
+	const uint32_t _prime32_2 = 0x85EBCA77U;
+	const uint32_t _prime32_3 = 0xC2B2AE3DU;
+
+	const uint64_t _prime64_1 = 0x9E3779B185EBCA87ULL;
+	const uint64_t _prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+	const uint64_t _prime64_3 = 0x165667B19E3779F9ULL;
+	const uint64_t _prime64_4 = 0x85EBCA77C2B2AE63ULL;
+	const uint64_t _prime64_5 = 0x27D4EB2F165667C5ULL;
+
+	const uint64_t _prime_mx1 = 0x165667919E3779F9ULL;
+	const uint64_t _prime_mx2 = 0x9FB21C651E98DF25ULL;
+
+	// the default secret
+	const uint8_t _secret[192] = {
+		0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+		0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+		0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+		0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+		0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+		0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+		0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+		0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+		0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+		0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+		0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+		0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+	};
+
+	const size_t _stripe_length = 64;
+	const size_t _stripes_per_block = (sizeof(_secret) - _stripe_length) / 8;
+	const size_t _block_length = _stripe_length * _stripes_per_block;
+	const size_t _midsize_max = 240;
+
+	struct uint128 {
+		uint64_t low;
+		uint64_t high;
+	};
+
+	inline uint32_t read32(const uint8_t* p) {
+		uint32_t x;
+		memcpy(&x, p, sizeof(x));	// Windows targets are all little endian
+		return x;
+	}
+
+	inline uint64_t read64(const uint8_t* p) {
+		uint64_t x;
+		memcpy(&x, p, sizeof(x));
+		return x;
+	}
+
+	inline uint32_t swap32(uint32_t x) {
+		return ((x << 24) & 0xff000000) | ((x << 8) & 0x00ff0000) |
+			((x >> 8) & 0x0000ff00) | ((x >> 24) & 0x000000ff);
+	}
+
+	inline uint64_t swap64(uint64_t x) {
+		return (static_cast<uint64_t>(swap32(static_cast<uint32_t>(x))) << 32) |
+			swap32(static_cast<uint32_t>(x >> 32));
+	}
+
+	inline uint32_t rotl32(uint32_t x, int n) {
+		return (x << n) | (x >> (32 - n));
+	}
+
+	inline uint64_t rotl64(uint64_t x, int n) {
+		return (x << n) | (x >> (64 - n));
+	}
+
+	inline uint128 mult64to128(uint64_t a, uint64_t b) {
+		uint128 r;
+#if defined(_MSC_VER) && defined(_M_X64)
+		r.low = _umul128(a, b, &r.high);
+#elif defined(__SIZEOF_INT128__)
+		const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+		r.low = static_cast<uint64_t>(product);
+		r.high = static_cast<uint64_t>(product >> 64);
+#else
+		// 32 bit targets
+		const uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+		const uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+		const uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+		const uint64_t hi_hi = (a >> 32) * (b >> 32);
+		const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+		r.high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+		r.low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+#endif
+		return r;
+	}
+
+	inline uint64_t mul128_fold64(uint64_t a, uint64_t b) {
+		const uint128 product = mult64to128(a, b);
+		return product.low ^ product.high;
+	}
+
+	inline uint64_t xxh64_avalanche(uint64_t h) {
+		h ^= h >> 33;
+		h *= _prime64_2;
+		h ^= h >> 29;
+		h *= _prime64_3;
+		h ^= h >> 32;
+		return h;
+	}
+
+	inline uint64_t avalanche(uint64_t h) {
+		h ^= h >> 37;
+		h *= _prime_mx1;
+		h ^= h >> 32;
+		return h;
+	}
+
+	inline uint64_t rrmxmx(uint64_t h, uint64_t length) {
+		h ^= rotl64(h, 49) ^ rotl64(h, 24);
+		h *= _prime_mx2;
+		h ^= (h >> 35) + length;
+		h *= _prime_mx2;
+		h ^= h >> 28;
+		return h;
+	}
+
+	inline uint64_t mix16(const uint8_t* input, const uint8_t* secret) {
+		return mul128_fold64(read64(input) ^ read64(secret), read64(input + 8) ^ read64(secret + 8));
+	}
+
+	inline void mix32(uint128& acc, const uint8_t* input_1, const uint8_t* input_2, const uint8_t* secret) {
+		acc.low += mix16(input_1, secret);
+		acc.low ^= read64(input_2) + read64(input_2 + 8);
+		acc.high += mix16(input_2, secret + 16);
+		acc.high ^= read64(input_1) + read64(input_1 + 8);
+	}
+
+	// 64 bit hash of up to 240 bytes
+	uint64_t hash64_short(const uint8_t* input, size_t length) {
+		if (length == 0)
+			return xxh64_avalanche(read64(_secret + 56) ^ read64(_secret + 64));
+
+		if (length <= 3) {
+			const uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) |
+				(static_cast<uint32_t>(input[length >> 1]) << 24) |
+				static_cast<uint32_t>(input[length - 1]) | (static_cast<uint32_t>(length) << 8);
+			const uint64_t bitflip = read32(_secret) ^ read32(_secret + 4);
+			return xxh64_avalanche(combined ^ bitflip);
+		}
+
+		if (length <= 8) {
+			const uint64_t bitflip = read64(_secret + 8) ^ read64(_secret + 16);
+			const uint64_t input64 = read32(input + length - 4) +
+				(static_cast<uint64_t>(read32(input)) << 32);
+			return rrmxmx(input64 ^ bitflip, length);
+		}
+
+		if (length <= 16) {
+			const uint64_t input_low = read64(input) ^ (read64(_secret + 24) ^ read64(_secret + 32));
+			const uint64_t input_high = read64(input + length - 8) ^ (read64(_secret + 40) ^ read64(_secret + 48));
+			return avalanche(length + swap64(input_low) + input_high + mul128_fold64(input_low, input_high));
+		}
+
+		uint64_t acc = length * _prime64_1;
+
+		if (length <= 128) {
+			if (length > 32) {
+				if (length > 64) {
+					if (length > 96) {
+						acc += mix16(input + 48, _secret + 96);
+						acc += mix16(input + length - 64, _secret + 112);
+					}
+					acc += mix16(input + 32, _secret + 64);
+					acc += mix16(input + length - 48, _secret + 80);
+				}
+				acc += mix16(input + 16, _secret + 32);
+				acc += mix16(input + length - 32, _secret + 48);
+			}
+			acc += mix16(input, _secret);
+			acc += mix16(input + length - 16, _secret + 16);
+			return avalanche(acc);
+		}
+
+		const size_t rounds = length / 16;
+		for (size_t i = 0; i < 8; i++)
+			acc += mix16(input + 16 * i, _secret + 16 * i);
+
+		acc = avalanche(acc);
+
+		for (size_t i = 8; i < rounds; i++)
+			acc += mix16(input + 16 * i, _secret + 16 * (i - 8) + 3);
+
+		acc += mix16(input + length - 16, _secret + 136 - 17);
+		return avalanche(acc);
+	}
+
+	inline uint128 finish128(const uint128& acc, size_t length) {
+		uint128 h;
+		h.low = avalanche(acc.low + acc.high);
+		h.high = 0 - avalanche(acc.low * _prime64_1 + acc.high * _prime64_4 + length * _prime64_2);
+		return h;
+	}
+
+	// 128 bit hash of up to 240 bytes
+	uint128 hash128_short(const uint8_t* input, size_t length) {
+		if (length == 0) {
+			uint128 h;
+			h.low = xxh64_avalanche(read64(_secret + 64) ^ read64(_secret + 72));
+			h.high = xxh64_avalanche(read64(_secret + 80) ^ read64(_secret + 88));
+			return h;
+		}
+
+		if (length <= 3) {
+			const uint32_t combined_low = (static_cast<uint32_t>(input[0]) << 16) |
+				(static_cast<uint32_t>(input[length >> 1]) << 24) |
+				static_cast<uint32_t>(input[length - 1]) | (static_cast<uint32_t>(length) << 8);
+			const uint32_t combined_high = rotl32(swap32(combined_low), 13);
+			const uint64_t bitflip_low = read32(_secret) ^ read32(_secret + 4);
+			const uint64_t bitflip_high = read32(_secret + 8) ^ read32(_secret + 12);
+
+			uint128 h;
+			h.low = xxh64_avalanche(combined_low ^ bitflip_low);
+			h.high = xxh64_avalanche(combined_high ^ bitflip_high);
+			return h;
+		}
+
+		if (length <= 8) {
+			const uint64_t input64 = read32(input) +
+				(static_cast<uint64_t>(read32(input + length - 4)) << 32);
+			const uint64_t bitflip = read64(_secret + 16) ^ read64(_secret + 24);
+
+			uint128 m = mult64to128(input64 ^ bitflip, _prime64_1 + (length << 2));
+			m.high += m.low << 1;
+			m.low ^= m.high >> 3;
+			m.low ^= m.low >> 35;
+			m.low *= _prime_mx2;
+			m.low ^= m.low >> 28;
+			m.high = avalanche(m.high);
+			return m;
+		}
+
+		if (length <= 16) {
+			const uint64_t bitflip_low = read64(_secret + 32) ^ read64(_secret + 40);
+			const uint64_t bitflip_high = read64(_secret + 48) ^ read64(_secret + 56);
+			const uint64_t input_low = read64(input);
+			uint64_t input_high = read64(input + length - 8);
+
+			uint128 m = mult64to128(input_low ^ input_high ^ bitflip_low, _prime64_1);
+			m.low += static_cast<uint64_t>(length - 1) << 54;
+			input_high ^= bitflip_high;
+			m.high += input_high + static_cast<uint64_t>(static_cast<uint32_t>(input_high)) * (_prime32_2 - 1);
+			m.low ^= swap64(m.high);
+
+			uint128 h = mult64to128(m.low, _prime64_2);
+			h.high += m.high * _prime64_2;
+			h.low = avalanche(h.low);
+			h.high = avalanche(h.high);
+			return h;
+		}
+
+		uint128 acc = { length * _prime64_1, 0 };
+
+		if (length <= 128) {
+			if (length > 32) {
+				if (length > 64) {
+					if (length > 96)
+						mix32(acc, input + 48, input + length - 64, _secret + 96);
+
+					mix32(acc, input + 32, input + length - 48, _secret + 64);
+				}
+				mix32(acc, input + 16, input + length - 32, _secret + 32);
+			}
+			mix32(acc, input, input + length - 16, _secret);
+			return finish128(acc, length);
+		}
+
+		const size_t rounds = length / 32;
+		for (size_t i = 0; i < 4; i++)
+			mix32(acc, input + 32 * i, input + 32 * i + 16, _secret + 32 * i);
+
+		acc.low = avalanche(acc.low);
+		acc.high = avalanche(acc.high);
+
+		for (size_t i = 4; i < rounds; i++)
+			mix32(acc, input + 32 * i, input + 32 * i + 16, _secret + 3 + 32 * (i - 4));
+
+		mix32(acc, input + length - 16, input + length - 32, _secret + 136 - 17 - 16);
+		return finish128(acc, length);
+	}
+
+	void accumulate512_scalar(uint64_t* acc, const uint8_t* input, const uint8_t* secret) {
+		for (size_t i = 0; i < 8; i++) {
+			const uint64_t data = read64(input + 8 * i);
+			const uint64_t key = data ^ read64(secret + 8 * i);
+			acc[i ^ 1] += data;
+			acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+		}
+	}
+
+	void scramble_scalar(uint64_t* acc, const uint8_t* secret) {
+		for (size_t i = 0; i < 8; i++) {
+			uint64_t a = acc[i];
+			a ^= a >> 47;
+			a ^= read64(secret + 8 * i);
+			a *= _prime32_1;
+			acc[i] = a;
+		}
+	}
+
+#if defined(LECCORE_XXH3_SIMD)
+	void accumulate512_sse2(uint64_t* acc, const uint8_t* input, const uint8_t* secret) {
+		__m128i* xacc = reinterpret_cast<__m128i*>(acc);
+
+		for (size_t i = 0; i < 4; i++) {
+			const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input) + i);
+			const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+			const __m128i data_key = _mm_xor_si128(data, key);
+			const __m128i data_key_high = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+			const __m128i product = _mm_mul_epu32(data_key, data_key_high);
+			const __m128i data_swap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+			const __m128i sum = _mm_add_epi64(_mm_loadu_si128(xacc + i), data_swap);
+			_mm_storeu_si128(xacc + i, _mm_add_epi64(product, sum));
+		}
+	}
+
+	void scramble_sse2(uint64_t* acc, const uint8_t* secret) {
+		__m128i* xacc = reinterpret_cast<__m128i*>(acc);
+		const __m128i prime = _mm_set1_epi32(static_cast<int>(_prime32_1));
+
+		for (size_t i = 0; i < 4; i++) {
+			const __m128i a = _mm_loadu_si128(xacc + i);
+			const __m128i data = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+			const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+			const __m128i data_key = _mm_xor_si128(data, key);
+			const __m128i data_key_high = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+			const __m128i product_low = _mm_mul_epu32(data_key, prime);
+			const __m128i product_high = _mm_mul_epu32(data_key_high, prime);
+			_mm_storeu_si128(xacc + i, _mm_add_epi64(product_low, _mm_slli_epi64(product_high, 32)));
+		}
+	}
+
+	void accumulate512_avx2(uint64_t* acc, const uint8_t* input, const uint8_t* secret) {
+		__m256i* xacc = reinterpret_cast<__m256i*>(acc);
+
+		for (size_t i = 0; i < 2; i++) {
+			const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input) + i);
+			const __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i);
+			const __m256i data_key = _mm256_xor_si256(data, key);
+			const __m256i data_key_high = _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+			const __m256i product = _mm256_mul_epu32(data_key, data_key_high);
+			const __m256i data_swap = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+			const __m256i sum = _mm256_add_epi64(_mm256_loadu_si256(xacc + i), data_swap);
+			_mm256_storeu_si256(xacc + i, _mm256_add_epi64(product, sum));
+		}
+	}
+
+	void scramble_avx2(uint64_t* acc, const uint8_t* secret) {
+		__m256i* xacc = reinterpret_cast<__m256i*>(acc);
+		const __m256i prime = _mm256_set1_epi32(static_cast<int>(_prime32_1));
+
+		for (size_t i = 0; i < 2; i++) {
+			const __m256i a = _mm256_loadu_si256(xacc + i);
+			const __m256i data = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+			const __m256i key = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i);
+			const __m256i data_key = _mm256_xor_si256(data, key);
+			const __m256i data_key_high = _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+			const __m256i product_low = _mm256_mul_epu32(data_key, prime);
+			const __m256i product_high = _mm256_mul_epu32(data_key_high, prime);
+			_mm256_storeu_si256(xacc + i, _mm256_add_epi64(product_low, _mm256_slli_epi64(product_high, 32)));
+		}
+	}
+#endif
+
+	struct kernels {
+		void (*accumulate512)(uint64_t*, const uint8_t*, const uint8_t*);
+		void (*scramble)(uint64_t*, const uint8_t*);
+	};
+
+	const kernels& select_kernels() {
+#if defined(LECCORE_XXH3_SIMD)
+		static const kernels selected = CryptoPP::HasAVX2() ?
+			kernels{ accumulate512_avx2, scramble_avx2 } :
+			kernels{ accumulate512_sse2, scramble_sse2 };
+#else
+		static const kernels selected = { accumulate512_scalar, scramble_scalar };
+#endif
+		return selected;
+	}
+
+	void accumulate(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripes) {
+		const auto accumulate512 = select_kernels().accumulate512;
+
+		for (size_t i = 0; i < stripes; i++)
+			accumulate512(acc, input + _stripe_length * i, secret + 8 * i);
+	}
+
+	// accumulate stripes that continue a block already stripes_so_far stripes in
+	void consume_stripes(uint64_t* acc, size_t& stripes_so_far, const uint8_t* input, size_t stripes) {
+		if (_stripes_per_block - stripes_so_far <= stripes) {
+			const size_t to_end = _stripes_per_block - stripes_so_far;
+			accumulate(acc, input, _secret + 8 * stripes_so_far, to_end);
+			select_kernels().scramble(acc, _secret + sizeof(_secret) - _stripe_length);
+			accumulate(acc, input + _stripe_length * to_end, _secret, stripes - to_end);
+			stripes_so_far = stripes - to_end;
+		}
+		else {
+			accumulate(acc, input, _secret + 8 * stripes_so_far, stripes);
+			stripes_so_far += stripes;
+		}
+	}
+
+	uint64_t merge_accs(const uint64_t* acc, const uint8_t* secret, uint64_t start) {
+		uint64_t result = start;
+		for (size_t i = 0; i < 4; i++)
+			result += mul128_fold64(acc[2 * i] ^ read64(secret + 16 * i),
+				acc[2 * i + 1] ^ read64(secret + 16 * i + 8));
+
+		return avalanche(result);
+	}
+
+	void store_big_endian(uint8_t* p, uint64_t x) {
+		for (int i = 7; i >= 0; i--, x >>= 8)
+			p[i] = static_cast<uint8_t>(x);
+	}
+}
+
+xxh3_hash::xxh3_hash(unsigned int bits) :
+	_bits(bits == 128 ? 128 : 64) {
+	Restart();
+}
+
+void xxh3_hash::Update(const CryptoPP::byte* input, size_t length) {
+	_total_length += length;
+
+	if (length <= BUFFERSIZE - _buffered) {
+		memcpy(_buffer + _buffered, input, length);
+		_buffered += length;
+		return;
+	}
+
+	// the buffer is only consumed once more data arrives, so the last stripe is never consumed
+	// before the digest is taken
+	if (_buffered) {
+		const size_t fill = BUFFERSIZE - _buffered;
+		memcpy(_buffer + _buffered, input, fill);
+		input += fill;
+		length -= fill;
+		consume_stripes(_acc, _stripes_so_far, _buffer, BUFFERSIZE / _stripe_length);
+		_buffered = 0;
+	}
+
+	if (length > BUFFERSIZE) {
+		// whole blocks straight from the input
+		const size_t blocks = (length - 1) / _block_length;
+		if (blocks > 0 && _stripes_so_far == 0) {
+			for (size_t i = 0; i < blocks; i++) {
+				accumulate(_acc, input, _secret, _stripes_per_block);
+				select_kernels().scramble(_acc, _secret + sizeof(_secret) - _stripe_length);
+				input += _block_length;
+				length -= _block_length;
+			}
+		}
+
+		while (length > BUFFERSIZE) {
+			consume_stripes(_acc, _stripes_so_far, input, BUFFERSIZE / _stripe_length);
+			input += BUFFERSIZE;
+			length -= BUFFERSIZE;
+		}
+
+		// the last stripe may be needed by the digest
+		memcpy(_buffer + BUFFERSIZE - _stripe_length, input - _stripe_length, _stripe_length);
+	}
+
+	memcpy(_buffer, input, length);
+	_buffered = length;
+}
+
+void xxh3_hash::TruncatedFinal(CryptoPP::byte* digest, size_t digestSize) {
+	ThrowIfInvalidTruncatedSize(digestSize);
+
+	uint8_t full[16];
+
+	if (_total_length <= _midsize_max) {
+		if (_bits == 64)
+			store_big_endian(full, hash64_short(_buffer, _buffered));
+		else {
+			const uint128 h = hash128_short(_buffer, _buffered);
+			store_big_endian(full, h.high);
+			store_big_endian(full + 8, h.low);
+		}
+	}
+	else {
+		uint64_t acc[8];
+		memcpy(acc, _acc, sizeof(acc));
+		size_t stripes_so_far = _stripes_so_far;
+
+		uint8_t last_stripe[_stripe_length];
+		const uint8_t* p_last_stripe = nullptr;
+
+		if (_buffered >= _stripe_length) {
+			consume_stripes(acc, stripes_so_far, _buffer, (_buffered - 1) / _stripe_length);
+			p_last_stripe = _buffer + _buffered - _stripe_length;
+		}
+		else {
+			// the last stripe starts in data that has already been consumed
+			const size_t catch_up = _stripe_length - _buffered;
+			memcpy(last_stripe, _buffer + BUFFERSIZE - catch_up, catch_up);
+			memcpy(last_stripe + catch_up, _buffer, _buffered);
+			p_last_stripe = last_stripe;
+		}
+
+		select_kernels().accumulate512(acc, p_last_stripe, _secret + sizeof(_secret) - _stripe_length - 7);
+
+		const uint64_t low = merge_accs(acc, _secret + 11, _total_length * _prime64_1);
+
+		if (_bits == 64)
+			store_big_endian(full, low);
+		else {
+			const uint64_t high = merge_accs(acc, _secret + sizeof(_secret) - _stripe_length - 11,
+				~(_total_length * _prime64_2));
+			store_big_endian(full, high);
+			store_big_endian(full + 8, low);
+		}
+	}
+
+	memcpy(digest, full, digestSize);
+	Restart();
+}
+
+void xxh3_hash::Restart() {
+	_acc[0] = _prime32_3;
+	_acc[1] = _prime64_1;
+	_acc[2] = _prime64_2;
+	_acc[3] = _prime64_3;
+	_acc[4] = _prime64_4;
+	_acc[5] = _prime32_2;
+	_acc[6] = _prime64_5;
+	_acc[7] = _prime32_1;
+
+	_buffered = 0;
+	_stripes_so_far = 0;
+	_total_length = 0;
+}
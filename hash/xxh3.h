@@ -0,0 +1,45 @@
+//
+// xxh3.h - XXH3 hash interface
+//
+// leccore library, part of the liblec library
+// Copyright (c) 2019 Alec Musasa (alecmus at live dot com)
+//
+// Released under the MIT license. For full details see the
+// file LICENSE.txt
+//
+
+#pragma once
+
+#include <cryptlib.h>
+#include <cstdint>
+
+namespace liblec {
+	namespace leccore {
+		// XXH3 non-cryptographic hash, 64 or 128 bits, as a Crypto++ hash so it can be used anywhere
+		// the other hashes are. The digest is in the canonical (big endian) byte order, so its hex
+		// form matches the one of the reference xxhash tools. Stripes are accumulated with AVX2 or SSE2.
+		class xxh3_hash : public CryptoPP::HashTransformation {
+		public:
+			// bits is either 64 or 128
+			explicit xxh3_hash(unsigned int bits = 64);
+
+			std::string AlgorithmName() const override { return _bits == 64 ? "XXH3-64" : "XXH3-128"; }
+			unsigned int DigestSize() const override { return _bits / 8; }
+			unsigned int OptimalBlockSize() const override { return BUFFERSIZE; }
+
+			void Update(const CryptoPP::byte* input, size_t length) override;
+			void TruncatedFinal(CryptoPP::byte* digest, size_t digestSize) override;
+			void Restart() override;
+
+		private:
+			static const unsigned int BUFFERSIZE = 256;
+
+			unsigned int _bits;
+			uint64_t _acc[8];
+			uint8_t _buffer[BUFFERSIZE];
+			size_t _buffered;
+			size_t _stripes_so_far;
+			uint64_t _total_length;
+		};
+	}
+}
@@ -12,12 +12,15 @@
 
 #if defined(LECCORE_EXPORTS)
 #include "leccore.h"
+#include "executor.h"
 #else
 #include <liblec/leccore.h>
+#include <liblec/leccore/executor.h>
 #endif
 
 #include <string>
 #include <vector>
+#include <functional>
 
 namespace liblec {
 	namespace leccore {
@@ -74,6 +77,37 @@ namespace liblec {
 			bool result(update_info& details,
 				std::string& error);
 
+			/// <summary>Set a function to be called when the update check completes.</summary>
+			/// <param name="callback">The function to call. It is called on the thread that did the
+			/// checking, right after the result becomes available, so it can call <see cref="result"></see>.</param>
+			/// <remarks>Set the callback before calling <see cref="start"></see>.</remarks>
+			void on_complete(std::function<void()> callback);
+
+			/// <summary>Wait for the update check to complete.</summary>
+			/// <param name="timeout_milliseconds">The maximum time to wait, in milliseconds.</param>
+			/// <returns>Returns true if the update check is complete, else false if the timeout elapsed first.</returns>
+			bool wait(unsigned long long timeout_milliseconds);
+
+			/// <summary>Get the completion event.</summary>
+			/// <returns>A handle to a manual-reset Win32 event object (HANDLE) that is signaled when
+			/// the update check completes. It is reset by <see cref="start"></see> and <see cref="result"></see>.</returns>
+			/// <remarks>Use this with WaitForMultipleObjects, MsgWaitForMultipleObjects or
+			/// RegisterWaitForSingleObject to wake your event loop exactly when the update check completes
+			/// instead of polling. The handle is owned by this object; do not close it.</remarks>
+			void* completion_event();
+
+			/// <summary>Cancel checking for updates.</summary>
+			/// <remarks>This method returns immediately. Checking stops before the next chunk is downloaded and
+			/// <see cref="result"></see> then returns false with the error "Operation cancelled". Destroying
+			/// this object also cancels any operation that is still underway.</remarks>
+			void cancel();
+
+			/// <summary>Set a cancellation token to observe in addition to <see cref="cancel"></see>.</summary>
+			/// <param name="token">The token, as defined in <see cref="cancellation_token"></see>. Share one
+			/// token between several objects to cancel all of their operations at once.</param>
+			/// <remarks>The token applies to operations started after this call.</remarks>
+			void set_cancellation_token(const cancellation_token& token);
+
 		private:
 			class impl;
 			impl& _d;
@@ -131,6 +165,38 @@ namespace liblec {
 			bool result(std::string& fullpath,
 				std::string& error);
 
+			/// <summary>Set a function to be called when the download completes.</summary>
+			/// <param name="callback">The function to call. It is called on the thread that did the
+			/// downloading, right after the result becomes available, so it can call <see cref="result"></see>.</param>
+			/// <remarks>Set the callback before calling <see cref="start"></see>.</remarks>
+			void on_complete(std::function<void()> callback);
+
+			/// <summary>Wait for the download to complete.</summary>
+			/// <param name="timeout_milliseconds">The maximum time to wait, in milliseconds.</param>
+			/// <returns>Returns true if the download is complete, else false if the timeout elapsed first.</returns>
+			bool wait(unsigned long long timeout_milliseconds);
+
+			/// <summary>Get the completion event.</summary>
+			/// <returns>A handle to a manual-reset Win32 event object (HANDLE) that is signaled when
+			/// the download completes. It is reset by <see cref="start"></see> and <see cref="result"></see>.</returns>
+			/// <remarks>Use this with WaitForMultipleObjects, MsgWaitForMultipleObjects or
+			/// RegisterWaitForSingleObject to wake your event loop exactly when the download completes
+			/// instead of polling. The handle is owned by this object; do not close it.</remarks>
+			void* completion_event();
+
+			/// <summary>Cancel the download.</summary>
+			/// <remarks>This method returns immediately. The download stops before the next chunk is received,
+			/// the partial file is deleted and <see cref="result"></see> then returns false with the error
+			/// "Operation cancelled". Destroying this object also cancels any operation that is still
+			/// underway.</remarks>
+			void cancel();
+
+			/// <summary>Set a cancellation token to observe in addition to <see cref="cancel"></see>.</summary>
+			/// <param name="token">The token, as defined in <see cref="cancellation_token"></see>. Share one
+			/// token between several objects to cancel all of their operations at once.</param>
+			/// <remarks>The token applies to operations started after this call.</remarks>
+			void set_cancellation_token(const cancellation_token& token);
+
 		private:
 			class impl;
 			impl& _d;
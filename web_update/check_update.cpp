@@ -11,8 +11,7 @@
 #include "../web_update.h"
 #include "download.h"
 #include "parse_update_xml.h"
-#include <thread>
-#include <future>
+#include "../executor/async_task.h"
 
 using namespace liblec::leccore;
 
@@ -25,10 +24,11 @@ public:
 	};
 
 	const std::string _update_xml_url;
-	std::future<check_update_result> _fut;
+	async_task<check_update_result> _task;
 
 	impl(const std::string& update_xml_url) :
-		_update_xml_url(update_xml_url) {}
+		_update_xml_url(update_xml_url),
+		_task(blocking_executor) {}
 	~impl() {}
 
 	class string_download_sink : public download_sink {
@@ -68,7 +68,8 @@ public:
 		}
 
 		string_download_sink sink;
-		if (!download(_d._update_xml_url, sink, true, result.error)) {
+		if (!download(_d._update_xml_url, sink, true,
+			[&_d]() { return _d._task.cancelled(); }, result.error)) {
 			result.success = false;
 			return result;
 		}
@@ -86,10 +87,8 @@ public:
 check_update::check_update(const std::string& update_xml_url) :
 	_d(*new impl(update_xml_url)) {}
 check_update::~check_update() {
-	if (_d._fut.valid()) {
-		// to-do: add mechanism for stopping immediately
-		_d._fut.get();
-	}
+	_d._task.cancel();
+	_d._task.join();
 
 	delete& _d;
 }
@@ -101,15 +100,12 @@ void check_update::start() {
 	}
 
 	// run task asynchronously
-	_d._fut = std::async(std::launch::async, _d.check_update_func, &_d);
+	_d._task.start(_d.check_update_func, &_d);
 	return;
 }
 
 bool check_update::checking() {
-	if (_d._fut.valid())
-		return _d._fut.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready;
-	else
-		return false;
+	return _d._task.running();
 }
 
 bool check_update::result(update_info& details, std::string& error) {
@@ -121,8 +117,8 @@ bool check_update::result(update_info& details, std::string& error) {
 		return false;
 	}
 
-	if (_d._fut.valid()) {
-		auto result = _d._fut.get();
+	if (_d._task.valid()) {
+		auto result = _d._task.get();
 		details = result.details;
 		error = result.error;
 		return result.success;
@@ -131,3 +127,23 @@ bool check_update::result(update_info& details, std::string& error) {
 	error = "unexpected error";
 	return false;
 }
+
+void check_update::on_complete(std::function<void()> callback) {
+	_d._task.on_complete(callback);
+}
+
+bool check_update::wait(unsigned long long timeout_milliseconds) {
+	return _d._task.wait(timeout_milliseconds);
+}
+
+void* check_update::completion_event() {
+	return _d._task.completion_event();
+}
+
+void check_update::cancel() {
+	_d._task.cancel();
+}
+
+void check_update::set_cancellation_token(const cancellation_token& token) {
+	_d._task.link(token);
+}
@@ -95,7 +95,8 @@ std::string get_url_filename(const URL_COMPONENTSA& urlc) {
 }
 
 bool liblec::leccore::download(const std::string& url,
-	download_sink& sink, bool cache_data, std::string& error) {
+	download_sink& sink, bool cache_data,
+	const std::function<bool()>& cancelled, std::string& error) {
 	char url_path[512];
 	URL_COMPONENTSA urlc;
 	memset(&urlc, 0, sizeof(urlc));
@@ -198,6 +199,11 @@ bool liblec::leccore::download(const std::string& url,
 
 	// download the data
 	while (true) {
+		if (cancelled()) {
+			error = "Operation cancelled";
+			return false;
+		}
+
 		DWORD read;
 		if (!InternetReadFile(conn, buffer, sizeof(buffer), &read)) {
 			error = get_last_error();
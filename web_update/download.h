@@ -11,6 +11,7 @@
 #pragma once
 
 #include <string>
+#include <functional>
 
 namespace liblec {
 	namespace leccore {
@@ -22,7 +23,10 @@ namespace liblec {
 			virtual std::string get_fullpath() = 0;
 		};
 
+		// cancelled is checked before each chunk is read; the download fails with
+		// "Operation cancelled" as soon as it returns true
 		bool download(const std::string& url,
-			download_sink& sink, bool cache_data, std::string& error);
+			download_sink& sink, bool cache_data,
+			const std::function<bool()>& cancelled, std::string& error);
 	}
 }
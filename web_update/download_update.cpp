@@ -11,8 +11,7 @@
 #include "../web_update.h"
 #include "../leccore_common.h"
 #include "download.h"
-#include <thread>
-#include <future>
+#include "../executor/async_task.h"
 #include <time.h>
 
 using namespace liblec::leccore;
@@ -27,12 +26,13 @@ public:
 
 	std::string _url;
 	std::string _directory;
-	std::future<download_update_result> _fut;
+	async_task<download_update_result> _task;
 	
 	download_info _progress;
 	mutex _progress_mutex;
 
 	impl() :
+		_task(blocking_executor),
 		_progress({ 0, 0 }) {}
 	~impl() {}
 
@@ -137,12 +137,18 @@ public:
 
 		update_download_sink sink(_d._directory, _d._progress, _d._progress_mutex);
 
-		result.success = download(_d._url, sink, true, result.error);
+		result.success = download(_d._url, sink, true,
+			[&_d]() { return _d._task.cancelled(); }, result.error);
 		
 		sink.close();
 
-		if (!result.success)
+		if (!result.success) {
+			// don't leave a partial update file behind
+			if (_d._task.cancelled() && !sink.get_fullpath().empty())
+				remove(sink.get_fullpath().c_str());
+
 			return result;
+		}
 
 		result.fullpath = sink.get_fullpath();
 		result.success = true;
@@ -152,10 +158,8 @@ public:
 
 download_update::download_update() : _d(*new impl()) {}
 download_update::~download_update() {
-	if (_d._fut.valid()) {
-		// to-do: add mechanism for stopping immediately
-		_d._fut.get();
-	}
+	_d._task.cancel();
+	_d._task.join();
 	
 	delete& _d;
 }
@@ -171,15 +175,12 @@ void download_update::start(const std::string& url,
 	_d._directory = directory;
 
 	// run task asynchronously
-	_d._fut = std::async(std::launch::async, _d.download_update_func, &_d);
+	_d._task.start(_d.download_update_func, &_d);
 	return;
 }
 
 bool download_update::downloading() {
-	if (_d._fut.valid())
-		return _d._fut.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready;
-	else
-		return false;
+	return _d._task.running();
 }
 
 bool download_update::downloading(download_info& progress) {
@@ -200,8 +201,8 @@ bool download_update::result(std::string& fullpath,
 		return false;
 	}
 
-	if (_d._fut.valid()) {
-		auto result = _d._fut.get();
+	if (_d._task.valid()) {
+		auto result = _d._task.get();
 		fullpath = result.fullpath;
 		error = result.error;
 		return result.success;
@@ -210,3 +211,23 @@ bool download_update::result(std::string& fullpath,
 	error = "unexpected error";
 	return false;
 }
+
+void download_update::on_complete(std::function<void()> callback) {
+	_d._task.on_complete(callback);
+}
+
+bool download_update::wait(unsigned long long timeout_milliseconds) {
+	return _d._task.wait(timeout_milliseconds);
+}
+
+void* download_update::completion_event() {
+	return _d._task.completion_event();
+}
+
+void download_update::cancel() {
+	_d._task.cancel();
+}
+
+void download_update::set_cancellation_token(const cancellation_token& token) {
+	_d._task.link(token);
+}
@@ -12,12 +12,15 @@
 
 #if defined(LECCORE_EXPORTS)
 #include "leccore.h"
+#include "executor.h"
 #else
 #include <liblec/leccore.h>
+#include <liblec/leccore/executor.h>
 #endif
 
 #include <string>
 #include <vector>
+#include <functional>
 
 namespace liblec {
 	namespace leccore {
@@ -70,6 +73,38 @@ namespace liblec {
 			/// error information is written back to <see cref="error"></see>.</returns>
 			bool result(std::string& error);
 
+			/// <summary>Set a function to be called when zipping completes.</summary>
+			/// <param name="callback">The function to call. It is called on the thread that did the
+			/// zipping, right after the result becomes available, so it can call <see cref="result"></see>.</param>
+			/// <remarks>Set the callback before calling <see cref="start"></see>.</remarks>
+			void on_complete(std::function<void()> callback);
+
+			/// <summary>Wait for zipping to complete.</summary>
+			/// <param name="timeout_milliseconds">The maximum time to wait, in milliseconds.</param>
+			/// <returns>Returns true if zipping is complete, else false if the timeout elapsed first.</returns>
+			bool wait(unsigned long long timeout_milliseconds);
+
+			/// <summary>Get the completion event.</summary>
+			/// <returns>A handle to a manual-reset Win32 event object (HANDLE) that is signaled when
+			/// zipping completes. It is reset by <see cref="start"></see> and <see cref="result"></see>.</returns>
+			/// <remarks>Use this with WaitForMultipleObjects, MsgWaitForMultipleObjects or
+			/// RegisterWaitForSingleObject to wake your event loop exactly when zipping completes
+			/// instead of polling. The handle is owned by this object; do not close it.</remarks>
+			void* completion_event();
+
+			/// <summary>Cancel zipping.</summary>
+			/// <remarks>This method returns immediately. Zipping stops before the next chunk is written, the
+			/// incomplete archive is deleted and <see cref="result"></see> then returns false with the error
+			/// "Operation cancelled". Destroying this object also cancels any operation that is still
+			/// underway.</remarks>
+			void cancel();
+
+			/// <summary>Set a cancellation token to observe in addition to <see cref="cancel"></see>.</summary>
+			/// <param name="token">The token, as defined in <see cref="cancellation_token"></see>. Share one
+			/// token between several objects to cancel all of their operations at once.</param>
+			/// <remarks>The token applies to operations started after this call.</remarks>
+			void set_cancellation_token(const cancellation_token& token);
+
 		private:
 			class impl;
 			impl& _d;
@@ -117,6 +152,37 @@ namespace liblec {
 			/// error information is written back to <see cref="error"></see>.</returns>
 			bool result(unzip_log& log, std::string& error);
 
+			/// <summary>Set a function to be called when unzipping completes.</summary>
+			/// <param name="callback">The function to call. It is called on the thread that did the
+			/// unzipping, right after the result becomes available, so it can call <see cref="result"></see>.</param>
+			/// <remarks>Set the callback before calling <see cref="start"></see>.</remarks>
+			void on_complete(std::function<void()> callback);
+
+			/// <summary>Wait for unzipping to complete.</summary>
+			/// <param name="timeout_milliseconds">The maximum time to wait, in milliseconds.</param>
+			/// <returns>Returns true if unzipping is complete, else false if the timeout elapsed first.</returns>
+			bool wait(unsigned long long timeout_milliseconds);
+
+			/// <summary>Get the completion event.</summary>
+			/// <returns>A handle to a manual-reset Win32 event object (HANDLE) that is signaled when
+			/// unzipping completes. It is reset by <see cref="start"></see> and <see cref="result"></see>.</returns>
+			/// <remarks>Use this with WaitForMultipleObjects, MsgWaitForMultipleObjects or
+			/// RegisterWaitForSingleObject to wake your event loop exactly when unzipping completes
+			/// instead of polling. The handle is owned by this object; do not close it.</remarks>
+			void* completion_event();
+
+			/// <summary>Cancel unzipping.</summary>
+			/// <remarks>This method returns immediately. Unzipping stops before the next chunk of the archive
+			/// is read and <see cref="result"></see> then returns false with the error "Operation cancelled".
+			/// Destroying this object also cancels any operation that is still underway.</remarks>
+			void cancel();
+
+			/// <summary>Set a cancellation token to observe in addition to <see cref="cancel"></see>.</summary>
+			/// <param name="token">The token, as defined in <see cref="cancellation_token"></see>. Share one
+			/// token between several objects to cancel all of their operations at once.</param>
+			/// <remarks>The token applies to operations started after this call.</remarks>
+			void set_cancellation_token(const cancellation_token& token);
+
 		private:
 			class impl;
 			impl& _d;
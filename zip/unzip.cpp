@@ -9,8 +9,8 @@
 //
 
 #include "../zip.h"
-#include <thread>
-#include <future>
+#include "../executor/async_task.h"
+#include "../executor/cancellable_streambuf.h"
 #include <fstream>
 #include <filesystem>
 
@@ -36,9 +36,10 @@ public:
 		std::string error;
 	};
 
-	std::future<unzip_result> _fut;
+	async_task<unzip_result> _task;
 
-	impl() {}
+	impl() :
+		_task(blocking_executor) {}
 	~impl() {}
 
 	void on_error(const void*, std::pair<const Poco::Zip::ZipLocalFileHeader, const std::string>& info) {
@@ -90,14 +91,18 @@ public:
 				std::filesystem::create_directories(path);
 			}
 
-			std::ifstream in(_d._filename, std::ios::binary);
+			std::ifstream file_in(_d._filename, std::ios::binary);
 
-			if (!in.is_open()) {
+			if (!file_in.is_open()) {
 				result.error = "Error opening file";
 				result.success = false;
 				return result;
 			}
 
+			// makes the archive appear to end as soon as the operation is cancelled
+			cancellable_istreambuf buffer(*file_in.rdbuf(), [&_d]() { return _d._task.cancelled(); });
+			std::istream in(&buffer);
+
 			Poco::Zip::Decompress decompress(in, _d._directory);
 
 			decompress.EError += Poco::Delegate<unzip::impl,
@@ -112,16 +117,22 @@ public:
 			decompress.EOk -= Poco::Delegate<unzip::impl,
 				std::pair<const Poco::Zip::ZipLocalFileHeader, const Poco::Path> >(p_impl, &unzip::impl::on_ok);
 
+			if (_d._task.cancelled()) {
+				result.error = "Operation cancelled";
+				result.success = false;
+				return result;
+			}
+
 			result.success = true;
 			return result;
 		}
 		catch (Poco::Exception& e) {
-			result.error = e.displayText();
+			result.error = _d._task.cancelled() ? "Operation cancelled" : e.displayText();
 			result.success = false;
 			return result;
 		}
 		catch (const std::exception& e) {
-			result.error = e.what();
+			result.error = _d._task.cancelled() ? "Operation cancelled" : e.what();
 			result.success = false;
 			return result;
 		}
@@ -130,8 +141,8 @@ public:
 
 unzip::unzip() : _d(*new impl()) {}
 unzip::~unzip() {
-	if (_d._fut.valid())
-		_d._fut.get();
+	_d._task.cancel();
+	_d._task.join();
 
 	delete& _d;
 }
@@ -148,15 +159,12 @@ void unzip::start(const std::string& filename,
 	_d._log = {};
 
 	// run task asynchronously
-	_d._fut = std::async(std::launch::async, _d.unzip_func, &_d);
+	_d._task.start(_d.unzip_func, &_d);
 	return;
 }
 
 bool unzip::unzipping() {
-	if (_d._fut.valid())
-		return _d._fut.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready;
-	else
-		return false;
+	return _d._task.running();
 }
 
 bool unzip::result(unzip_log& log, std::string& error) {
@@ -168,8 +176,8 @@ bool unzip::result(unzip_log& log, std::string& error) {
 		return false;
 	}
 
-	if (_d._fut.valid()) {
-		auto result = _d._fut.get();
+	if (_d._task.valid()) {
+		auto result = _d._task.get();
 		error = result.error;
 		log = _d._log;
 		return result.success;
@@ -179,3 +187,23 @@ bool unzip::result(unzip_log& log, std::string& error) {
 	log = _d._log;
 	return false;
 }
+
+void unzip::on_complete(std::function<void()> callback) {
+	_d._task.on_complete(callback);
+}
+
+bool unzip::wait(unsigned long long timeout_milliseconds) {
+	return _d._task.wait(timeout_milliseconds);
+}
+
+void* unzip::completion_event() {
+	return _d._task.completion_event();
+}
+
+void unzip::cancel() {
+	_d._task.cancel();
+}
+
+void unzip::set_cancellation_token(const cancellation_token& token) {
+	_d._task.link(token);
+}
@@ -9,8 +9,8 @@
 //
 
 #include "../zip.h"
-#include <thread>
-#include <future>
+#include "../executor/async_task.h"
+#include "../executor/cancellable_streambuf.h"
 #include <fstream>
 #include <filesystem>
 
@@ -37,12 +37,25 @@ public:
 		std::string error;
 	};
 
-	std::future<zip_result> _fut;
+	async_task<zip_result> _task;
 
 	impl() :
-		_add_root(true) {}
+		_add_root(true),
+		_task(blocking_executor) {}
 	~impl() {}
 
+	// called by Poco after each file is added to the archive
+	void on_done(const void*, const Poco::Zip::ZipLocalFileHeader&) {
+		if (_task.cancelled())
+			throw Poco::Exception("Operation cancelled");
+	}
+
+	// remove the incomplete archive left behind by a cancelled operation
+	void remove_incomplete_archive() {
+		std::error_code ec;
+		std::filesystem::remove(_filename, ec);
+	}
+
 	static zip_result zip_func(impl* p_impl) {
 		impl& _d = *p_impl;
 
@@ -78,10 +91,20 @@ public:
 				return result;
 			}
 
-			std::ofstream out(_d._filename, std::ios::binary | std::ios::trunc);
+			std::ofstream file_out(_d._filename, std::ios::binary | std::ios::trunc);
+
+			// stops writing to the archive as soon as the operation is cancelled
+			cancellable_ostreambuf buffer(*file_out.rdbuf(), [&_d]() { return _d._task.cancelled(); });
+			std::ostream out(&buffer);
+
 			Poco::Zip::Compress compress(out, true);
+			compress.EDone += Poco::Delegate<zip::impl,
+				const Poco::Zip::ZipLocalFileHeader>(p_impl, &zip::impl::on_done);
 
 			for (const auto& it : _d._entries) {
+				if (_d._task.cancelled())
+					throw Poco::Exception("Operation cancelled");
+
 				Poco::File file(it);
 
 				if (file.exists()) {
@@ -123,17 +146,36 @@ public:
 				}
 			}
 
+			compress.EDone -= Poco::Delegate<zip::impl,
+				const Poco::Zip::ZipLocalFileHeader>(p_impl, &zip::impl::on_done);
+
 			compress.close();
+
+			if (_d._task.cancelled())
+				throw Poco::Exception("Operation cancelled");
+
 			result.success = true;
 			return result;
 		}
 		catch (Poco::Exception& e) {
-			result.error = e.displayText();
+			if (_d._task.cancelled()) {
+				_d.remove_incomplete_archive();
+				result.error = "Operation cancelled";
+			}
+			else
+				result.error = e.displayText();
+
 			result.success = false;
 			return result;
 		}
 		catch (const std::exception& e) {
-			result.error = e.what();
+			if (_d._task.cancelled()) {
+				_d.remove_incomplete_archive();
+				result.error = "Operation cancelled";
+			}
+			else
+				result.error = e.what();
+
 			result.success = false;
 			return result;
 		}
@@ -142,8 +184,8 @@ public:
 
 zip::zip() : _d(*new impl()) {}
 zip::~zip() {
-	if (_d._fut.valid())
-		_d._fut.get();
+	_d._task.cancel();
+	_d._task.join();
 
 	delete& _d;
 }
@@ -161,15 +203,12 @@ void zip::start(const std::string& filename,
 	_d._level = level;
 
 	// run task asynchronously
-	_d._fut = std::async(std::launch::async, _d.zip_func, &_d);
+	_d._task.start(_d.zip_func, &_d);
 	return;
 }
 
 bool zip::zipping() {
-	if (_d._fut.valid())
-		return _d._fut.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready;
-	else
-		return false;
+	return _d._task.running();
 }
 
 bool zip::result(std::string& error) {
@@ -180,8 +219,8 @@ bool zip::result(std::string& error) {
 		return false;
 	}
 
-	if (_d._fut.valid()) {
-		auto result = _d._fut.get();
+	if (_d._task.valid()) {
+		auto result = _d._task.get();
 		error = result.error;
 		return result.success;
 	}
@@ -189,3 +228,23 @@ bool zip::result(std::string& error) {
 	error = "unexpected error";
 	return false;
 }
+
+void zip::on_complete(std::function<void()> callback) {
+	_d._task.on_complete(callback);
+}
+
+bool zip::wait(unsigned long long timeout_milliseconds) {
+	return _d._task.wait(timeout_milliseconds);
+}
+
+void* zip::completion_event() {
+	return _d._task.completion_event();
+}
+
+void zip::cancel() {
+	_d._task.cancel();
+}
+
+void zip::set_cancellation_token(const cancellation_token& token) {
+	_d._task.link(token);
+}